@@ -0,0 +1,402 @@
+#include "src/graph_generator.h"
+#include "src/array_id_func.h"
+#include "src/tiny_id_func.h"
+#include "src/id_func.h"
+#include "src/id_multi_func.h"
+#include "src/chain.h"
+#include "src/permutation.h"
+#include "src/preorder.h"
+#include "src/sort_arc.h"
+#include "src/back_arc.h"
+#include "src/timer.h"
+#include "src/flow_cutter_config.h"
+#include "src/flow_cutter_accelerated.h"
+#include "src/dinic.h"
+#include "src/inertial_flow.h"
+#include "src/contraction_graph.h"
+#include "src/elimination_tree.h"
+#include "src/connected_components.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace{
+
+	struct Graph{
+		std::string name;
+		GeneratedGraph g;
+		RangeIDIDMultiFunc out_arc;
+		ArrayIDIDFunc back_arc;
+
+		// Approximate number of bytes of a graph traversal that reads every out-arc
+		// range and every head once.
+		long long traversal_bytes()const{
+			return 4ll*(g.node_count()+1) + 4ll*g.arc_count();
+		}
+	};
+
+	// Renumbers the nodes like the reorder_nodes_in_preorder console command, such
+	// that the kernels see the node layout that the order computation sees.
+	GeneratedGraph reorder_in_preorder(GeneratedGraph g){
+		auto p = compute_preorder(compute_successor_function(g.tail, g.head)).first;
+		auto inv_p = inverse_permutation(p);
+		g.tail = chain(std::move(g.tail), inv_p);
+		g.head = chain(std::move(g.head), inv_p);
+		g.geo_pos = chain(p, std::move(g.geo_pos));
+		auto q = sort_arcs_first_by_tail_second_by_head(g.tail, g.head);
+		g.tail = chain(q, std::move(g.tail));
+		g.head = chain(q, std::move(g.head));
+		return g; // NVRO
+	}
+
+	Graph make_graph(std::string name, GeneratedGraph g){
+		Graph graph;
+		graph.name = std::move(name);
+		graph.g = reorder_in_preorder(std::move(g));
+		graph.out_arc = invert_sorted_id_id_func(graph.g.tail);
+		graph.back_arc = compute_back_arc_permutation(graph.g.tail, graph.g.head);
+		return graph; // NVRO
+	}
+
+	// A nested dissection order that splits the nodes at the median coordinate and
+	// uses the nodes on one side of the split with a neighbor on the other side as
+	// separator. It is much worse than a flow cutter order but cheap enough to give
+	// compute_chordal_supergraph an input with realistic fill-in.
+	ArrayIDIDFunc compute_geometric_nested_dissection_order(const Graph&graph){
+		const int node_count = graph.g.node_count();
+		ArrayIDFunc<int>label(node_count);
+		label.fill(-1);
+		int next_label = 0;
+
+		std::vector<int>order;
+		order.reserve(node_count);
+
+		auto recurse = [&](std::vector<int>nodes, auto&recurse)->void{
+			if(nodes.size() <= 64){
+				order.insert(order.end(), nodes.begin(), nodes.end());
+				return;
+			}
+
+			double min_lat = graph.g.geo_pos(nodes[0]).lat, max_lat = min_lat;
+			double min_lon = graph.g.geo_pos(nodes[0]).lon, max_lon = min_lon;
+			for(int x:nodes){
+				min_lat = std::min(min_lat, graph.g.geo_pos(x).lat);
+				max_lat = std::max(max_lat, graph.g.geo_pos(x).lat);
+				min_lon = std::min(min_lon, graph.g.geo_pos(x).lon);
+				max_lon = std::max(max_lon, graph.g.geo_pos(x).lon);
+			}
+			bool split_lat = max_lat - min_lat > max_lon - min_lon;
+			auto coord = [&](int x){ return split_lat ? graph.g.geo_pos(x).lat : graph.g.geo_pos(x).lon; };
+
+			auto mid = nodes.begin() + nodes.size()/2;
+			std::nth_element(nodes.begin(), mid, nodes.end(), [&](int l, int r){ return coord(l) < coord(r); });
+
+			int upper_label = next_label++;
+			for(auto i=mid; i!=nodes.end(); ++i)
+				label[*i] = upper_label;
+
+			std::vector<int>lower, upper(mid, nodes.end()), separator;
+			for(auto i=nodes.begin(); i!=mid; ++i){
+				bool is_separator = false;
+				for(int xy:graph.out_arc(*i))
+					if(label(graph.g.head(xy)) == upper_label)
+						is_separator = true;
+				if(is_separator)
+					separator.push_back(*i);
+				else
+					lower.push_back(*i);
+			}
+			nodes.clear();
+			nodes.shrink_to_fit();
+
+			recurse(std::move(lower), recurse);
+			recurse(std::move(upper), recurse);
+			order.insert(order.end(), separator.begin(), separator.end());
+		};
+
+		std::vector<int>all_nodes(node_count);
+		for(int x=0; x<node_count; ++x)
+			all_nodes[x] = x;
+		recurse(std::move(all_nodes), recurse);
+
+		ArrayIDIDFunc result(node_count, node_count);
+		std::copy(order.begin(), order.end(), result.begin());
+		return result; // NVRO
+	}
+
+	struct Kernel{
+		std::string name;
+		long long bytes;
+		std::vector<long long>running_time;
+		long long result;
+	};
+
+	//! Runs setup and then run, once as warm-up and then repetition_count times.
+	//! Only run is timed. run returns a value that depends on the whole
+	//! computation, such that it can not be optimized away and changes of the
+	//! results are noticed.
+	template<class Setup, class Run>
+	Kernel measure(std::string name, long long bytes, int repetition_count, const Setup&setup, const Run&run){
+		Kernel k;
+		k.name = std::move(name);
+		k.bytes = bytes;
+		{
+			auto state = setup();
+			k.result = run(state);
+		}
+		for(int i=0; i<repetition_count; ++i){
+			auto state = setup();
+			long long time = -get_micro_time();
+			long long result = run(state);
+			time += get_micro_time();
+			if(result != k.result)
+				throw std::runtime_error("Kernel "+k.name+" is not deterministic");
+			k.running_time.push_back(time);
+		}
+		return k; // NVRO
+	}
+
+	// The nearest-rank percentile of sorted values.
+	long long percentile(const std::vector<long long>&sorted, double p){
+		int rank = static_cast<int>(std::ceil(p*sorted.size()));
+		return sorted[std::max(rank, 1)-1];
+	}
+
+	void print_header(){
+		std::cout << "graph,node_count,arc_count,kernel,repetition_count,min,median,p95,max,bandwidth,result" << std::endl;
+	}
+
+	void print_kernel(const Graph&graph, Kernel k){
+		auto&t = k.running_time;
+		std::sort(t.begin(), t.end());
+		long long median = percentile(t, 0.5);
+		std::cout
+			<< graph.name << ',' << graph.g.node_count() << ',' << graph.g.arc_count() << ','
+			<< k.name << ',' << t.size() << ','
+			<< t.front() << ',' << median << ',' << percentile(t, 0.95) << ',' << t.back() << ','
+			<< std::fixed << std::setprecision(3) << static_cast<double>(k.bytes) / std::max(median, 1ll) / 1000.0 << std::defaultfloat << ','
+			<< k.result << std::endl;
+	}
+
+	bool is_selected(const std::vector<std::string>&selected, const std::string&name){
+		return selected.empty() || std::find(selected.begin(), selected.end(), name) != selected.end();
+	}
+
+	void run_kernels(const Graph&graph, int repetition_count, const std::vector<std::string>&selected){
+		const int node_count = graph.g.node_count();
+		const int arc_count = graph.g.arc_count();
+		const auto&tail = graph.g.tail;
+		const auto&head = graph.g.head;
+		const auto&geo_pos = graph.g.geo_pos;
+
+		flow_cutter::Config config;
+		auto cutter_graph = flow_cutter_accelerated::make_graph(
+			make_const_ref_id_id_func(tail),
+			make_const_ref_id_id_func(head),
+			make_const_ref_id_id_func(graph.back_arc),
+			make_const_ref_id_func(graph.out_arc)
+		);
+		flow_cutter_accelerated::CutterFactory factory(config);
+
+		auto no_setup = []{ return 0; };
+
+		if(is_selected(selected, "unit_dinic")){
+			ArrayIDIDFunc source_list, target_list;
+			inertial_flow::build_source_and_target_list(
+				node_count, 0.25,
+				[&](int l, int r){ return geo_pos(l).lon < geo_pos(r).lon; },
+				source_list, target_list
+			);
+			BitIDFunc is_source;
+			ArrayIDIDFunc source_front;
+			std::tie(is_source, source_front) = inertial_flow::build_is_source_and_source_front(graph.out_arc, head, source_list);
+
+			using Dinic = max_flow::UnitDinicAlgo<ArrayIDIDFunc, RangeIDIDMultiFunc, ArrayIDIDFunc, ArrayIDIDFunc, ArrayIDIDFunc, ArrayIDIDFunc>;
+			print_kernel(graph, measure(
+				"unit_dinic", graph.traversal_bytes() + 4ll*arc_count, repetition_count, no_setup,
+				[&](int){
+					Dinic dinic(tail, graph.out_arc, head, graph.back_arc, source_list, target_list, is_source, source_front);
+					do{
+						dinic.advance();
+					}while(!dinic.is_finished());
+					return static_cast<long long>(dinic.get_current_flow_intensity());
+				}
+			));
+		}
+
+		auto search = [&](const auto&search_algo)->long long{
+			flow_cutter_accelerated::TemporaryData tmp(node_count);
+			BitIDFunc seen(node_count);
+			seen.fill(false);
+			seen.set(0, true);
+			long long seen_count = 1;
+			search_algo(
+				cutter_graph, tmp, 0,
+				[&](int x){ return seen(x); },
+				[&](int x){ seen.set(x, true); ++seen_count; return true; },
+				[](int){ return true; },
+				[](int){}
+			);
+			return seen_count;
+		};
+
+		if(is_selected(selected, "pseudo_depth_first_search"))
+			print_kernel(graph, measure(
+				"pseudo_depth_first_search", graph.traversal_bytes(), repetition_count, no_setup,
+				[&](int){ return search(flow_cutter_accelerated::PseudoDepthFirstSearch()); }
+			));
+
+		if(is_selected(selected, "breadth_first_search"))
+			print_kernel(graph, measure(
+				"breadth_first_search", graph.traversal_bytes(), repetition_count, no_setup,
+				[&](int){ return search(flow_cutter_accelerated::BreadthFirstSearch()); }
+			));
+
+		if(is_selected(selected, "distance_aware_cutter_init")){
+			auto geo_order = factory.build_geo_order(node_count, [&](int l, int r){ return geo_pos(l).lon < geo_pos(r).lon; });
+			flow_cutter_accelerated::DistanceAwareCutter cutter(cutter_graph, config);
+			flow_cutter_accelerated::TemporaryData tmp(node_count);
+			print_kernel(graph, measure(
+				"distance_aware_cutter_init", 2*graph.traversal_bytes(), repetition_count,
+				[&]{ return geo_order; },
+				[&](std::vector<int>&order){
+					cutter.init(
+						cutter_graph, tmp, flow_cutter_accelerated::PseudoDepthFirstSearch(),
+						flow_cutter_accelerated::DistanceType::hop_distance,
+						{std::move(order), false, {-1, -1}, 0},
+						config.bulk_distance_factor, config.random_seed, geo_pos
+					);
+					return static_cast<long long>(cutter.get_assimilated_node_count());
+				}
+			));
+		}
+
+		if(is_selected(selected, "build_geo_order"))
+			print_kernel(graph, measure(
+				"build_geo_order", 4ll*node_count + 16ll*node_count, repetition_count, no_setup,
+				[&](int){
+					const double pi = 3.141592653589793238463;
+					const double lat_factor = std::cos(pi/8), lon_factor = std::sin(pi/8);
+					auto order = factory.build_geo_order(node_count, [&](int l, int r){
+						return geo_pos(l).lat*lat_factor + geo_pos(l).lon*lon_factor < geo_pos(r).lat*lat_factor + geo_pos(r).lon*lon_factor;
+					});
+					return static_cast<long long>(order.front()) * node_count + order.back();
+				}
+			));
+
+		if(is_selected(selected, "biconnected_components"))
+			print_kernel(graph, measure(
+				"biconnected_components", graph.traversal_bytes() + 4ll*arc_count, repetition_count, no_setup,
+				[&](int){
+					return static_cast<long long>(compute_biconnected_components(graph.out_arc, head, graph.back_arc).image_count());
+				}
+			));
+
+		if(is_selected(selected, "parallel_biconnected_components"))
+			print_kernel(graph, measure(
+				"parallel_biconnected_components", graph.traversal_bytes() + 4ll*arc_count, repetition_count, no_setup,
+				[&](int){
+					return static_cast<long long>(compute_biconnected_components_in_parallel(graph.out_arc, head, graph.back_arc).image_count());
+				}
+			));
+
+		if(is_selected(selected, "chordal_supergraph") || is_selected(selected, "symbolic_elimination")){
+			auto order = compute_geometric_nested_dissection_order(graph);
+			auto inv_order = inverse_permutation(order);
+			ArrayIDIDFunc ordered_tail = chain(tail, inv_order);
+			ArrayIDIDFunc ordered_head = chain(head, inv_order);
+
+			// Both kernels have the same result.
+			if(is_selected(selected, "chordal_supergraph"))
+				print_kernel(graph, measure(
+					"chordal_supergraph", 8ll*arc_count, repetition_count, no_setup,
+					[&](int){
+						long long upward_arc_count = 0;
+						int max_upward_degree = compute_chordal_supergraph(ordered_tail, ordered_head, [&](int, int){ ++upward_arc_count; });
+						return upward_arc_count * node_count + max_upward_degree;
+					}
+				));
+
+			if(is_selected(selected, "symbolic_elimination"))
+				print_kernel(graph, measure(
+					"symbolic_elimination", 8ll*arc_count, repetition_count, no_setup,
+					[&](int){
+						auto upward_degree = compute_symbolic_elimination(ordered_tail, ordered_head).upward_degree;
+						long long upward_arc_count = 0;
+						int max_upward_degree = 0;
+						for(auto d:upward_degree){
+							upward_arc_count += d;
+							max_upward_degree = std::max(max_upward_degree, d);
+						}
+						return upward_arc_count * node_count + max_upward_degree;
+					}
+				));
+		}
+	}
+}
+
+int main(int argc, char**argv){
+	if(argc < 3){
+		std::cout
+			<< "Usage: " << argv[0] << " grid|road node_count [repetition_count [kernel ...]]\n"
+			<< "\n"
+			<< "Times the hot kernels of the order computation on a generated graph with about\n"
+			<< "node_count nodes. Every kernel is run once as warm-up and then repetition_count\n"
+			<< "times (default 11). Times are in microseconds. The bandwidth in GB/s is the size\n"
+			<< "of the arrays that the kernel reads at least once divided by the median time.\n"
+			<< "It is a lower bound of the memory bandwidth, that makes kernels comparable across\n"
+			<< "graph sizes. The result column is a checksum of the kernel output.\n"
+			<< "\n"
+			<< "Kernels: unit_dinic pseudo_depth_first_search breadth_first_search\n"
+			<< "distance_aware_cutter_init build_geo_order biconnected_components\n"
+			<< "parallel_biconnected_components chordal_supergraph symbolic_elimination" << std::endl;
+		return 1;
+	}
+
+	try{
+		std::string graph_type = argv[1];
+		int node_count = std::stoi(argv[2]);
+		int repetition_count = argc > 3 ? std::stoi(argv[3]) : 11;
+		std::vector<std::string>selected(argv + std::min(argc, 4), argv + argc);
+
+		const std::vector<std::string>kernel_names = {
+			"unit_dinic", "pseudo_depth_first_search", "breadth_first_search",
+			"distance_aware_cutter_init", "build_geo_order", "biconnected_components",
+			"parallel_biconnected_components", "chordal_supergraph", "symbolic_elimination"
+		};
+		for(auto&k:selected)
+			if(std::find(kernel_names.begin(), kernel_names.end(), k) == kernel_names.end())
+				throw std::runtime_error("Unknown kernel "+k);
+		if(node_count < 4)
+			throw std::runtime_error("node_count must be at least 4");
+		if(repetition_count < 1)
+			throw std::runtime_error("repetition_count must be positive");
+
+		Graph graph;
+		if(graph_type == "grid"){
+			int width = std::max(static_cast<int>(std::sqrt(node_count)), 2);
+			graph = make_graph("grid", generate_grid_graph(width, node_count / width));
+		}else if(graph_type == "road"){
+			// The highway graph keeps about 1.5 roads per junction. Their chains of
+			// 0 to 2 nodes add about 1.5 nodes per junction and the highways about
+			// another half.
+			int junction_count = std::max(node_count/3, 4);
+			int width = std::max(static_cast<int>(std::sqrt(junction_count)), 2);
+			graph = make_graph("road", generate_highway_graph(width, junction_count / width, 3, 2, 5489));
+		}else{
+			throw std::runtime_error("Unknown graph type "+graph_type+"; valid are grid, road");
+		}
+
+		print_header();
+		run_kernels(graph, repetition_count, selected);
+	}catch(std::exception&err){
+		std::cerr << "Error: " << err.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
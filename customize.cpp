@@ -2,41 +2,229 @@
 #include <routingkit/vector_io.h>
 #include <routingkit/timer.h>
 #include <routingkit/inverse_vector.h>
+#include "src/routingkit_cch_structure.h"
 #include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <limits>
 
+// Runs f once to warm up and then repeat_count times, and prints the minimum, median
+// and maximum running time in microseconds. setup is called before every run and is
+// not timed.
+void time_repeatedly(
+    const std::string&name, unsigned repeat_count,
+    const std::function<void(unsigned)>&setup, const std::function<void()>&f
+) {
+    std::vector<double> times;
+    for (unsigned r = 0; r <= repeat_count; ++r) {
+        setup(r);
+        double time = -RoutingKit::get_micro_time();
+        f();
+        time += RoutingKit::get_micro_time();
+        if (r != 0)
+            times.push_back(time);
+    }
+    std::sort(times.begin(), times.end());
+    std::cout << name << " [us]: min " << times.front() << " median " << times[times.size() / 2] << " max " << times.back() << std::endl;
+}
 
-int main(int argc, char **argv) {
-    if (argc != 6) {
-        std::cout << "Usage: " << argv[0] << " first_out head order metric cores" << std::endl;
+// Parses a non-negative decimal number. std::stoul alone would accept a leading minus
+// sign and wrap the value around, and it would ignore trailing garbage.
+unsigned parse_unsigned(const std::string&name, const std::string&value) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+        throw std::runtime_error(name + " must be a non-negative number, but is \"" + value + "\"");
+    if (value.size() > 10 || std::stoul(value) > std::numeric_limits<unsigned>::max())
+        throw std::runtime_error(name + " is too large: " + value);
+    return std::stoul(value);
+}
+
+std::vector<unsigned> parse_core_counts(const std::string&list) {
+    std::vector<unsigned> cores;
+    std::istringstream in(list);
+    std::string c;
+    while (std::getline(in, c, ','))
+        cores.push_back(parse_unsigned("cores", c));
+    if (cores.empty() || std::find(cores.begin(), cores.end(), 0u) != cores.end())
+        throw std::runtime_error("The core counts must be a comma separated list of positive numbers");
+    return cores;
+}
+
+void print_usage(const char*program) {
+    std::cout << "Usage: " << program << " first_out head order metric cores [cch_structure file] [metric file]..." << std::endl;
+    std::cout << "       [repeats count] [perfect] [partial arc_count] [verify_cch_structure]" << std::endl;
+    std::cout << "Without further metrics, core counts, or options, prints the customization time in microseconds." << std::endl;
+    std::cout << "Otherwise, customizes every metric repeats times (default 9) after a warm-up for every core count" << std::endl;
+    std::cout << "in the comma separated list cores and prints min/median/max. perfect also times perfect customization alone," << std::endl;
+    std::cout << "partial the partial re-customization after changing the weights of arc_count random arcs." << std::endl;
+    std::cout << "verify_cch_structure compares the CCH built from cch_structure with the one RoutingKit contracts." << std::endl;
+}
+
+int run(int argc, char **argv) {
+    if (argc < 6) {
+        print_usage(argv[0]);
         return 1;
     }
 
     std::string first_out_file = argv[1];
     std::string head_file = argv[2];
     std::string order_file = argv[3];
-    std::string weight_file = argv[4];
-    int cores = std::stoi(argv[5]);
+    std::vector<std::string> weight_files = {argv[4]};
+    std::vector<unsigned> core_counts = parse_core_counts(argv[5]);
+
+    std::string cch_structure_file;
+    unsigned repeat_count = 9;
+    bool is_benchmark = core_counts.size() > 1;
+    bool time_perfect_customization = false;
+    unsigned partial_update_arc_count = 0;
+    bool verify_cch_structure = false;
+    for (int i = 6; i < argc; ++i) {
+        std::string option = argv[i];
+        auto value = [&] {
+            if (i + 1 == argc)
+                throw std::runtime_error("The option \"" + option + "\" needs a value");
+            return std::string(argv[++i]);
+        };
+        if (option == "cch_structure") {
+            cch_structure_file = value();
+        } else if (option == "metric") {
+            weight_files.push_back(value());
+            is_benchmark = true;
+        } else if (option == "repeats") {
+            repeat_count = parse_unsigned(option, value());
+            is_benchmark = true;
+        } else if (option == "perfect") {
+            time_perfect_customization = true;
+            is_benchmark = true;
+        } else if (option == "partial") {
+            partial_update_arc_count = parse_unsigned(option, value());
+            is_benchmark = true;
+        } else if (option == "verify_cch_structure") {
+            verify_cch_structure = true;
+        } else {
+            throw std::runtime_error("Unknown option \"" + option + "\"");
+        }
+    }
+    if (repeat_count == 0)
+        throw std::runtime_error("repeats must be positive");
+    if (verify_cch_structure && cch_structure_file.empty())
+        throw std::runtime_error("verify_cch_structure needs the option cch_structure");
 
     std::vector<unsigned> first_out = RoutingKit::load_vector<unsigned>(first_out_file);
     std::vector<unsigned> tail = RoutingKit::invert_inverse_vector(first_out);
     std::vector<unsigned> head = RoutingKit::load_vector<unsigned>(head_file);
     std::vector<unsigned> node_order = RoutingKit::load_vector<unsigned>(order_file);
-    std::vector<unsigned> weight = RoutingKit::load_vector<unsigned>(weight_file);
 
     //std::cout << "read input " << first_out.size() << " " << tail.size() << " " << head.size() << " " << node_order.size() << " " << weight.size() << std::endl;
-	RoutingKit::CustomizableContractionHierarchy cch(node_order, tail, head);
+	RoutingKit::CustomizableContractionHierarchy cch = !cch_structure_file.empty()
+		? load_routingkit_cch_structure(cch_structure_file, node_order, tail, head)
+		: RoutingKit::CustomizableContractionHierarchy(node_order, tail, head);
     //std::cout << "built CCH" << std::endl;
-	RoutingKit::CustomizableContractionHierarchyMetric metric(cch, weight);
-    //std::cout << "built metric" << std::endl;
-	double time = -RoutingKit::get_micro_time();
-	if (cores > 1) {
-		RoutingKit::CustomizableContractionHierarchyParallelization parallel_custom(cch);
-		parallel_custom.customize(metric, static_cast<unsigned int>(cores));
-	}
-	else {
-        metric.customize();
-	}
-	time += RoutingKit::get_micro_time();
-	std::cout << time << std::endl;
+
+    if (verify_cch_structure) {
+        verify_routingkit_cch_structure(cch, node_order, tail, head, RoutingKit::load_vector<unsigned>(weight_files[0]));
+        std::cout << "The CCH built from " << cch_structure_file << " equals the contracted one" << std::endl;
+    }
+
+    if (!is_benchmark) {
+        std::vector<unsigned> weight = RoutingKit::load_vector<unsigned>(weight_files[0]);
+        int cores = core_counts[0];
+        RoutingKit::CustomizableContractionHierarchyMetric metric(cch, weight);
+        //std::cout << "built metric" << std::endl;
+        double time = -RoutingKit::get_micro_time();
+        if (cores > 1) {
+            RoutingKit::CustomizableContractionHierarchyParallelization parallel_custom(cch);
+            parallel_custom.customize(metric, static_cast<unsigned int>(cores));
+        }
+        else {
+            metric.customize();
+        }
+        time += RoutingKit::get_micro_time();
+        std::cout << time << std::endl;
+        return 0;
+    }
+
+    // The metrics are customized in place. The metric keeps a pointer to the input
+    // weights, so the partial updates change current_weight and restore it from
+    // weight before every run.
+    RoutingKit::CustomizableContractionHierarchyParallelization parallel_custom(cch);
+    std::mt19937 gen(5489);
+    for (const auto&weight_file : weight_files) {
+        const std::vector<unsigned> weight = RoutingKit::load_vector<unsigned>(weight_file);
+        if (weight.size() != head.size())
+            throw std::runtime_error("The metric \"" + weight_file + "\" does not have one weight per arc");
+        std::vector<unsigned> current_weight = weight;
+        RoutingKit::CustomizableContractionHierarchyMetric metric(cch, current_weight);
+
+        for (unsigned cores : core_counts) {
+            time_repeatedly(
+                "metric " + weight_file + " cores " + std::to_string(cores) + " customization", repeat_count,
+                [](unsigned) {},
+                [&] {
+                    if (cores > 1)
+                        parallel_custom.customize(metric, cores);
+                    else
+                        metric.customize();
+                }
+            );
+        }
+
+        if (time_perfect_customization) {
+            // Perfect customization needs a customized metric. The customization runs
+            // untimed before every run, such that only the perfect customization is
+            // timed.
+            time_repeatedly(
+                "metric " + weight_file + " cores 1 perfect customization only", repeat_count,
+                [&](unsigned) {
+                    metric.customize();
+                },
+                [&] {
+                    metric.perfect_customize();
+                }
+            );
+        }
+
+        if (partial_update_arc_count != 0) {
+            // Every run starts from the customized metric, slows down a fresh random
+            // subset of the arcs by a factor between 1 and 3, as a traffic update would,
+            // and times the update of the metric.
+            RoutingKit::CustomizableContractionHierarchyPartialCustomization partial_custom(cch);
+            std::vector<unsigned> updated_arcs;
+            std::uniform_int_distribution<unsigned> random_arc(0, weight.size() - 1);
+            std::uniform_real_distribution<double> random_factor(1.0, 3.0);
+            time_repeatedly(
+                "metric " + weight_file + " cores 1 partial customization of " + std::to_string(partial_update_arc_count) + " arcs", repeat_count,
+                [&](unsigned) {
+                    std::copy(weight.begin(), weight.end(), current_weight.begin());
+                    metric.customize();
+                    updated_arcs.clear();
+                    for (unsigned i = 0; i < partial_update_arc_count; ++i)
+                        updated_arcs.push_back(random_arc(gen));
+                    for (unsigned a : updated_arcs)
+                        current_weight[a] = static_cast<unsigned>(std::min<double>(weight[a] * random_factor(gen), RoutingKit::inf_weight - 1));
+                },
+                [&] {
+                    partial_custom.reset();
+                    for (unsigned a : updated_arcs)
+                        partial_custom.update_arc(a);
+                    partial_custom.customize(metric);
+                }
+            );
+        }
+    }
     return 0;
 }
+
+int main(int argc, char **argv) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception&e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+}
@@ -7,34 +7,39 @@ def format_running_time(r):
     r = r.replace("musec", "")
     return round(int(r) / 1000000, 1)
 
+# Graphs other than the ones from the paper, such as generated ones, keep their
+# name and are listed after them in the order of the input file.
 graph_names = {"col" : "Col", "cal" : "Cal", "europe" : "Eur" , "usa" : "USA"}
 df = pd.read_csv(sys.argv[1])
 df["running_time_sec"] = df["running_time_musec"].map(format_running_time)
-df["graph"] = df["graph"].map(graph_names)
+df["graph"] = df["graph"].map(lambda g: graph_names.get(g, g))
+graphs = [G for G in graph_names.values() if G in set(df.graph)]
+graphs += [G for G in df.graph.unique() if G not in graphs]
+cores = sorted(df.cores.unique())
 
 
-print(r"\begin{tabular}{ll *{5}{r}}")
+print(r"\begin{tabular}{ll *{" + str(len(cores)) + r"}{r}}")
 print(r"\toprule")
 
-print(r"\multirow{2}{*}{Graph} &  & \multicolumn{5}{c}{Cores} \\")
-print(r"\cmidrule(lr){3-7}")
+print(r"\multirow{2}{*}{Graph} &  & \multicolumn{" + str(len(cores)) + r"}{c}{Cores} \\")
+print(r"\cmidrule(lr){3-" + str(len(cores)+2) + r"}")
 print(r" & & ",end='')
-print(" & ".join(map(str,[1,2,4,8,16])))
+print(" & ".join(map(str,cores)))
 print(r"\\")
 
 
 
-for G in ["Col","Cal","Eur","USA"]:
+for G in graphs:
     print(r"\midrule")
     print(r"\multirow{2}{*}{" + G + r"}", end='')
     print(" & Time [s]", end='')
-    for T in [1,2,4,8,16]:
+    for T in cores:
         time = float(df[(df.graph==G) & (df.cores==T)].running_time_sec)
         print(" &", time, end='') #slow but who cares
     print(r"\\")
     seq = time = float(df[(df.graph==G) & (df.cores==1)].running_time_sec)
     print(" & Speedup", end='')
-    for T in [1,2,4,8,16]:
+    for T in cores:
         time = float(df[(df.graph==G) & (df.cores==T)].running_time_sec)
         print(" &", round(seq / time, 1), end='')
     print(r"\\")
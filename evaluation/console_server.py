@@ -0,0 +1,54 @@
+import socket
+import subprocess
+import time
+
+# Talks to a console that was started with the serve command. The graph stays
+# loaded between calls, so that many orders can be computed without reloading it.
+#
+#     with ConsoleServer(console, "/tmp/ifc.sock", ["load_routingkit_unweighted_graph", g + "first_out", g + "head"]) as server:
+#         server.run("add_back_arcs")
+#         server.run("push_graph_snapshot")
+#         for config in configs:
+#             server.run("restore_graph_snapshot")
+#             ...
+class ConsoleServer:
+    def __init__(self, console, socket_path, setup_commands=None):
+        self.socket_path = socket_path
+        if setup_commands is None:
+            setup_commands = []
+        # The serve command replaces a stale socket, so an existing socket file
+        # is only usable once the console listens on it.
+        self.process = subprocess.Popen([console] + setup_commands + ["serve", socket_path], stdout=subprocess.DEVNULL)
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        while True:
+            try:
+                self.sock.connect(socket_path)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                if self.process.poll() is not None:
+                    self.sock.close()
+                    raise RuntimeError("console exited before it started serving")
+                time.sleep(0.1)
+        self.pending = b""
+
+    # Runs one command line and returns its output.
+    def run(self, command_line):
+        self.sock.sendall(command_line.encode() + b"\n")
+        while b"\0" not in self.pending:
+            data = self.sock.recv(1 << 16)
+            if not data:
+                raise RuntimeError("console closed the connection")
+            self.pending += data
+        output, self.pending = self.pending.split(b"\0", 1)
+        return output.decode()
+
+    def close(self):
+        self.sock.sendall(b"exit\n")
+        self.sock.close()
+        self.process.wait()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
@@ -2,11 +2,265 @@
 #include <routingkit/vector_io.h>
 #include <routingkit/timer.h>
 #include <routingkit/inverse_vector.h>
+#include <routingkit/constants.h>
+#include "src/routingkit_cch_structure.h"
 #include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <limits>
 
-int main(int argc, char **argv) {
-	if (argc != 7) {
-		std::cout << "Usage: " << argv[0] << " first_out head order metric query_sources query_tails" << std::endl;
+// Returns the q-quantile of a sorted vector by the nearest rank method.
+template<class T>
+T sorted_quantile(const std::vector<T>&v, double q) {
+	unsigned i = static_cast<unsigned>(std::ceil(q * v.size()));
+	return v[std::min<unsigned>(std::max(i, 1u), v.size()) - 1];
+}
+
+template<class T>
+void print_distribution(const std::string&name, std::vector<T>v) {
+	std::sort(v.begin(), v.end());
+	double sum = 0;
+	for (auto x : v)
+		sum += x;
+	std::cout << name << ": mean " << sum / v.size()
+		<< " p50 " << sorted_quantile(v, 0.5) << " p95 " << sorted_quantile(v, 0.95)
+		<< " p99 " << sorted_quantile(v, 0.99) << " max " << v.back() << std::endl;
+}
+
+// The query walks the elimination tree upward from the source and from the target
+// and relaxes the upward arcs of every node on the way. The search space is the
+// union of both paths, and the forward and backward arcs of the respective paths
+// are relaxed. As invalid_id is larger than every rank, a path that reached its root
+// simply stops advancing.
+void compute_search_space(
+	const RoutingKit::CustomizableContractionHierarchy&cch, unsigned s, unsigned t,
+	unsigned&node_count, unsigned&arc_count
+) {
+	auto degree = [&](unsigned x) { return cch.up_first_out[x+1] - cch.up_first_out[x]; };
+	node_count = 0;
+	arc_count = 0;
+	unsigned x = cch.rank[s], y = cch.rank[t];
+	while (x != y) {
+		++node_count;
+		if (x < y) {
+			arc_count += degree(x);
+			x = cch.elimination_tree_parent[x];
+		} else {
+			arc_count += degree(y);
+			y = cch.elimination_tree_parent[y];
+		}
+	}
+	for (; x != RoutingKit::invalid_id; x = cch.elimination_tree_parent[x]) {
+		++node_count;
+		arc_count += 2 * degree(x);
+	}
+}
+
+// Runs the queries on thread_count threads, each with its own query object over the
+// shared metric, and reports the throughput, the latency distribution, and the
+// search space sizes.
+void run_query_benchmark(
+	const RoutingKit::CustomizableContractionHierarchy&cch, const RoutingKit::CustomizableContractionHierarchyMetric&metric,
+	const std::vector<unsigned>&query_sources, const std::vector<unsigned>&query_targets, unsigned thread_count
+) {
+	const unsigned query_count = query_sources.size();
+	const unsigned chunk_size = 16;
+	std::vector<double> latency(query_count);
+	std::atomic<unsigned> next_query(0), ready_count(0);
+	std::atomic<bool> go(false);
+
+	std::vector<std::thread> threads;
+	for (unsigned i = 0; i < thread_count; ++i) {
+		threads.emplace_back([&] {
+			RoutingKit::CustomizableContractionHierarchyQuery query(metric);
+			++ready_count;
+			while (!go)
+				std::this_thread::yield();
+			for (;;) {
+				unsigned begin = next_query.fetch_add(chunk_size);
+				if (begin >= query_count)
+					break;
+				unsigned end = std::min(begin + chunk_size, query_count);
+				for (unsigned q = begin; q < end; ++q) {
+					auto start = std::chrono::steady_clock::now();
+					query.reset().add_source(query_sources[q]).add_target(query_targets[q]).run();
+					latency[q] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+				}
+			}
+		});
+	}
+	while (ready_count != thread_count)
+		std::this_thread::yield();
+	auto start = std::chrono::steady_clock::now();
+	go = true;
+	for (auto&t : threads)
+		t.join();
+	double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<unsigned> search_space_nodes(query_count), search_space_arcs(query_count);
+	for (unsigned q = 0; q < query_count; ++q)
+		compute_search_space(cch, query_sources[q], query_targets[q], search_space_nodes[q], search_space_arcs[q]);
+
+	std::cout << "threads: " << thread_count << std::endl;
+	std::cout << "queries: " << query_count << std::endl;
+	std::cout << "running time [s]: " << time << std::endl;
+	std::cout << "throughput [queries/s]: " << query_count / time << std::endl;
+	print_distribution("latency [us]", latency);
+	print_distribution("search space nodes", search_space_nodes);
+	print_distribution("search space arcs", search_space_arcs);
+}
+
+// Sums the finite entries of a distance table. Both modes compute the same table, so
+// a differing checksum points to a bug in one of them.
+unsigned long long compute_table_checksum(const std::vector<unsigned>&table) {
+	unsigned long long checksum = 0;
+	for (auto d : table)
+		if (d < RoutingKit::inf_weight)
+			checksum += d;
+	return checksum;
+}
+
+void print_table_report(const std::string&mode, unsigned batch_size, unsigned source_count, unsigned target_count, unsigned batch_count, double time, unsigned long long checksum) {
+	double entry_count = static_cast<double>(source_count) * target_count;
+	std::cout << "mode: " << mode << std::endl;
+	std::cout << "batch size: " << batch_size << std::endl;
+	std::cout << "sources: " << source_count << " targets: " << target_count << std::endl;
+	std::cout << "running time [s]: " << time << std::endl;
+	std::cout << "time per batch [us]: " << time * 1e6 / batch_count << std::endl;
+	std::cout << "time per table entry [ns]: " << time * 1e9 / entry_count << std::endl;
+	std::cout << "checksum: " << checksum << std::endl;
+}
+
+// Computes the table from every source to all targets as one-to-many queries, each
+// from one source to a batch of batch_size targets pinned in the query object. Only
+// the source is reset between the queries, as reset would also drop the targets.
+void run_one_to_many_benchmark(
+	const RoutingKit::CustomizableContractionHierarchyMetric&metric,
+	const std::vector<unsigned>&sources, const std::vector<unsigned>&targets, unsigned batch_size
+) {
+	RoutingKit::CustomizableContractionHierarchyQuery query(metric);
+	unsigned long long checksum = 0;
+	unsigned batch_count = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned begin = 0; begin < targets.size(); begin += batch_size) {
+		std::vector<unsigned> batch(targets.begin() + begin, targets.begin() + std::min<std::size_t>(begin + batch_size, targets.size()));
+		query.reset().pin_targets(batch);
+		for (auto s : sources) {
+			query.reset_source().add_source(s).run_to_pinned_targets();
+			checksum += compute_table_checksum(query.get_distances_to_targets());
+			++batch_count;
+		}
+	}
+	double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	print_table_report("one_to_many", batch_size, sources.size(), targets.size(), batch_count, time, checksum);
+}
+
+// Computes the table from every source to all targets in blocks of batch_size sources
+// times batch_size targets with buckets. The upward search spaces are the elimination
+// tree paths. The backward search of every target of a block stores its distances in
+// buckets at the nodes of its path, and the forward search of every source of the
+// block scans the buckets at the nodes of its path.
+void run_many_to_many_benchmark(
+	const RoutingKit::CustomizableContractionHierarchy&cch, const RoutingKit::CustomizableContractionHierarchyMetric&metric,
+	const std::vector<unsigned>&sources, const std::vector<unsigned>&targets, unsigned batch_size
+) {
+	const unsigned node_count = cch.rank.size();
+
+	struct BucketEntry {
+		unsigned target;
+		unsigned distance;
+	};
+	std::vector<std::vector<BucketEntry>> bucket(node_count);
+	std::vector<unsigned> bucket_nodes;
+	std::vector<unsigned> distance(node_count, RoutingKit::inf_weight);
+	std::vector<unsigned> table;
+
+	// Relaxes the upward arcs along the elimination tree path of x with the given
+	// weights and calls on_settle for every reached node on it.
+	auto search_path = [&](unsigned x, const std::vector<unsigned>&weight, const auto&on_settle) {
+		distance[x] = 0;
+		for (unsigned y = x; y != RoutingKit::invalid_id; y = cch.elimination_tree_parent[y]) {
+			unsigned d = distance[y];
+			if (d >= RoutingKit::inf_weight)
+				continue;
+			for (unsigned yz = cch.up_first_out[y]; yz < cch.up_first_out[y+1]; ++yz) {
+				unsigned z = cch.up_head[yz];
+				distance[z] = std::min(distance[z], d + weight[yz]);
+			}
+			on_settle(y, d);
+		}
+		for (unsigned y = x; y != RoutingKit::invalid_id; y = cch.elimination_tree_parent[y])
+			distance[y] = RoutingKit::inf_weight;
+	};
+
+	unsigned long long checksum = 0;
+	unsigned batch_count = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned target_begin = 0; target_begin < targets.size(); target_begin += batch_size) {
+		unsigned target_end = std::min<std::size_t>(target_begin + batch_size, targets.size());
+
+		for (auto x : bucket_nodes)
+			bucket[x].clear();
+		bucket_nodes.clear();
+		for (unsigned j = target_begin; j < target_end; ++j) {
+			search_path(cch.rank[targets[j]], metric.backward, [&](unsigned x, unsigned d) {
+				if (bucket[x].empty())
+					bucket_nodes.push_back(x);
+				bucket[x].push_back({j - target_begin, d});
+			});
+		}
+
+		for (unsigned source_begin = 0; source_begin < sources.size(); source_begin += batch_size) {
+			unsigned source_end = std::min<std::size_t>(source_begin + batch_size, sources.size());
+			unsigned batch_target_count = target_end - target_begin;
+
+			table.assign((source_end - source_begin) * batch_target_count, RoutingKit::inf_weight);
+			for (unsigned i = source_begin; i < source_end; ++i) {
+				unsigned*row = table.data() + (i - source_begin) * batch_target_count;
+				search_path(cch.rank[sources[i]], metric.forward, [&](unsigned x, unsigned d) {
+					for (auto&e : bucket[x])
+						row[e.target] = std::min(row[e.target], d + e.distance);
+				});
+			}
+			checksum += compute_table_checksum(table);
+			++batch_count;
+		}
+	}
+	double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	print_table_report("many_to_many", batch_size, sources.size(), targets.size(), batch_count, time, checksum);
+}
+
+// Parses a batch size or thread count. Unlike std::stoul alone, it rejects negative
+// numbers instead of wrapping them around.
+unsigned parse_unsigned(const std::string&name, const std::string&value) {
+	if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+		throw std::runtime_error(name + " must be a non-negative number, but is \"" + value + "\"");
+	if (value.size() > 10 || std::stoul(value) > std::numeric_limits<unsigned>::max())
+		throw std::runtime_error(name + " is too large: " + value);
+	return std::stoul(value);
+}
+
+void print_usage(const char*program) {
+	std::cout << "Usage: " << program << " first_out head order metric query_sources query_tails [cch_structure file] [threads count]" << std::endl;
+	std::cout << "       [one_to_many batch_size] [many_to_many batch_size]" << std::endl;
+	std::cout << "Without threads, prints the average query time in microseconds. With threads, runs the queries" << std::endl;
+	std::cout << "concurrently and reports the throughput, latency percentiles, and search space sizes." << std::endl;
+	std::cout << "one_to_many and many_to_many compute the distance table from all sources to all targets instead." << std::endl;
+}
+
+int run(int argc, char **argv) {
+	if (argc < 7 || argc % 2 != 1) {
+		print_usage(argv[0]);
 		return 1;
 	}
 
@@ -17,6 +271,24 @@ int main(int argc, char **argv) {
 	std::string query_sources_file = argv[5];
 	std::string query_targets_file = argv[6];
 
+	std::string cch_structure_file;
+	unsigned thread_count = 0;
+	unsigned one_to_many_batch_size = 0;
+	unsigned many_to_many_batch_size = 0;
+	for (int i = 7; i < argc; i += 2) {
+		std::string option = argv[i];
+		if (option == "cch_structure")
+			cch_structure_file = argv[i+1];
+		else if (option == "threads")
+			thread_count = parse_unsigned(option, argv[i+1]);
+		else if (option == "one_to_many")
+			one_to_many_batch_size = parse_unsigned(option, argv[i+1]);
+		else if (option == "many_to_many")
+			many_to_many_batch_size = parse_unsigned(option, argv[i+1]);
+		else
+			throw std::runtime_error("Unknown option \"" + option + "\"");
+	}
+
 	std::vector<unsigned> first_out = RoutingKit::load_vector<unsigned>(first_out_file);
 	std::vector<unsigned> tail = RoutingKit::invert_inverse_vector(first_out);
 	std::vector<unsigned> head = RoutingKit::load_vector<unsigned>(head_file);
@@ -24,10 +296,33 @@ int main(int argc, char **argv) {
 	std::vector<unsigned> weight = RoutingKit::load_vector<unsigned>(weight_file);
 	std::vector<unsigned> query_sources = RoutingKit::load_vector<unsigned>(query_sources_file);
 	std::vector<unsigned> query_targets = RoutingKit::load_vector<unsigned>(query_targets_file);
+	bool is_table_benchmark = one_to_many_batch_size != 0 || many_to_many_batch_size != 0;
+	if (query_sources.empty() || query_targets.empty())
+		throw std::runtime_error("The query sources and targets must be non-empty");
+	if (!is_table_benchmark && query_sources.size() != query_targets.size())
+		throw std::runtime_error("The query sources and targets must be of the same size");
+	if (is_table_benchmark && thread_count != 0)
+		throw std::runtime_error("The table benchmarks run on one thread");
 
-	RoutingKit::CustomizableContractionHierarchy cch(node_order, tail, head);
+	RoutingKit::CustomizableContractionHierarchy cch = !cch_structure_file.empty()
+		? load_routingkit_cch_structure(cch_structure_file, node_order, tail, head)
+		: RoutingKit::CustomizableContractionHierarchy(node_order, tail, head);
 	RoutingKit::CustomizableContractionHierarchyMetric metric(cch, weight);
 	metric.customize();
+
+	if (is_table_benchmark) {
+		if (one_to_many_batch_size != 0)
+			run_one_to_many_benchmark(metric, query_sources, query_targets, one_to_many_batch_size);
+		if (many_to_many_batch_size != 0)
+			run_many_to_many_benchmark(cch, metric, query_sources, query_targets, many_to_many_batch_size);
+		return 0;
+	}
+
+	if (thread_count != 0) {
+		run_query_benchmark(cch, metric, query_sources, query_targets, thread_count);
+		return 0;
+	}
+
 	RoutingKit::CustomizableContractionHierarchyQuery query(metric);
 	double time = -RoutingKit::get_micro_time();
 	for (int i = 0; i < (int) query_sources.size(); ++i) {
@@ -41,3 +336,13 @@ int main(int argc, char **argv) {
 	return 0;
 
 }
+
+int main(int argc, char **argv) {
+	try {
+		return run(argc, argv);
+	} catch (const std::exception&e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		print_usage(argv[0]);
+		return 1;
+	}
+}
@@ -112,6 +112,13 @@ public:
 		std::fill(data_, data_+preimage_count_, t);
 	}
 
+	// Drops all ids from new_preimage_count onwards without reallocating. The memory
+	// is only released once the array is destroyed.
+	void shrink_preimage_count(int new_preimage_count){
+		assert(0 <= new_preimage_count && new_preimage_count <= preimage_count_);
+		preimage_count_ = new_preimage_count;
+	}
+
 	// Array only functionality
 	T&operator[](int id){
 		assert(0 <= id && id < preimage_count_ && "id out of bounds");
@@ -0,0 +1,49 @@
+#ifndef ATOMIC_BIT_ID_FUNC_H
+#define ATOMIC_BIT_ID_FUNC_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cassert>
+
+//! A bool id func that several threads can modify concurrently. All operations use
+//! relaxed memory order, i.e., synchronization must happen outside.
+class AtomicBitIDFunc{
+public:
+	AtomicBitIDFunc():preimage_(0){}
+
+	explicit AtomicBitIDFunc(int preimage):
+		preimage_(preimage), data_(new std::atomic<std::uint64_t>[(preimage+63)/64]){
+		for(int i=0; i<(preimage+63)/64; ++i)
+			data_[i].store(0, std::memory_order_relaxed);
+	}
+
+	int preimage_count()const{
+		return preimage_;
+	}
+
+	bool operator()(int id)const{
+		assert(0 <= id && id < preimage_ && "id out of bounds");
+		return (data_[id/64].load(std::memory_order_relaxed) >> (id%64)) & 1;
+	}
+
+	//! Sets the bit and returns true if it was false before. If several threads set
+	//! the same bit, then exactly one of them gets true.
+	bool try_set(int id){
+		assert(0 <= id && id < preimage_ && "id out of bounds");
+		std::uint64_t mask = std::uint64_t(1) << (id%64);
+		return !(data_[id/64].fetch_or(mask, std::memory_order_relaxed) & mask);
+	}
+
+	void reset(int id){
+		assert(0 <= id && id < preimage_ && "id out of bounds");
+		std::uint64_t mask = std::uint64_t(1) << (id%64);
+		data_[id/64].fetch_and(~mask, std::memory_order_relaxed);
+	}
+
+private:
+	int preimage_;
+	std::unique_ptr<std::atomic<std::uint64_t>[]>data_;
+};
+
+#endif
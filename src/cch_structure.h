@@ -0,0 +1,235 @@
+#ifndef CCH_STRUCTURE_H
+#define CCH_STRUCTURE_H
+
+#include "contraction_graph.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+//! The metric independent part of a customizable contraction hierarchy, that is the
+//! upward arcs of the chordal supergraph produced by contracting the nodes by rank,
+//! its elimination tree, and the lower triangles of every arc. Nodes are identified
+//! by their rank. A file with this structure lets customization and query tools
+//! skip the contraction.
+//!
+//! The file consists of the following fields without padding. All integers are
+//! unsigned and little endian.
+//!
+//!   8 bytes                  magic "IFCCCH\0\0"
+//!   32 bit                   version, currently 1
+//!   32 bit                   node_count n
+//!   32 bit                   arc_count m, the number of upward arcs
+//!   32 bit                   zero
+//!   64 bit                   triangle_count t
+//!   32 bit x n               order, the input node ID of every rank
+//!   32 bit x (n+1)           first_out, the upward arcs of rank x are first_out[x]
+//!                            to first_out[x+1]-1
+//!   32 bit x m               head, increasing for every tail
+//!   32 bit x n               elimination_tree_parent, the head of the first upward
+//!                            arc of a rank or 0xFFFFFFFF if it has none
+//!   64 bit x (m+1)           first_lower_triangle, the lower triangles of arc xy are
+//!                            first_lower_triangle[xy] to first_lower_triangle[xy+1]-1
+//!   32 bit x 2t              lower_triangle, the arcs zx and zy of every lower
+//!                            triangle {z, x, y} of arc xy, increasing by z
+struct CCHStructure{
+	static constexpr unsigned invalid_id = 0xFFFFFFFFu;
+	static constexpr unsigned version = 1;
+
+	std::vector<unsigned>order;
+	std::vector<unsigned>first_out;
+	std::vector<unsigned>head;
+	std::vector<unsigned>elimination_tree_parent;
+	std::vector<std::uint64_t>first_lower_triangle;
+	std::vector<unsigned>lower_triangle;
+
+	unsigned node_count()const{ return order.size(); }
+	unsigned arc_count()const{ return head.size(); }
+	std::uint64_t triangle_count()const{ return lower_triangle.size() / 2; }
+
+	//! Returns the ID of the upward arc from x to y or invalid_id if there is none.
+	unsigned find_arc(unsigned x, unsigned y)const{
+		auto begin = head.begin() + first_out[x], end = head.begin() + first_out[x+1];
+		auto i = std::lower_bound(begin, end, y);
+		if(i == end || *i != y)
+			return invalid_id;
+		return i - head.begin();
+	}
+};
+
+//! Computes the CCH structure of a symmetric graph whose node IDs are the ranks.
+//! order maps every rank onto the node ID of the input graph.
+template<class Tail, class Head, class Order>
+CCHStructure compute_cch_structure(const Tail&tail, const Head&head, const Order&order){
+	const unsigned node_count = tail.image_count();
+
+	CCHStructure s;
+	s.order.resize(node_count);
+	for(unsigned x=0; x<node_count; ++x)
+		s.order[x] = order(x);
+
+	// The supergraph arcs are generated increasing by tail.
+	s.first_out.assign(node_count+1, 0);
+	compute_chordal_supergraph(
+		tail, head,
+		[&](int x, int y){
+			++s.first_out[x+1];
+			s.head.push_back(y);
+		}
+	);
+	for(unsigned x=0; x<node_count; ++x){
+		s.first_out[x+1] += s.first_out[x];
+		std::sort(s.head.begin() + s.first_out[x], s.head.begin() + s.first_out[x+1]);
+	}
+
+	s.elimination_tree_parent.resize(node_count);
+	for(unsigned x=0; x<node_count; ++x)
+		s.elimination_tree_parent[x] = s.first_out[x] == s.first_out[x+1] ? CCHStructure::invalid_id : s.head[s.first_out[x]];
+
+	// The upward neighbors of z form a clique. Every pair x < y of them is therefore a
+	// lower triangle of the arc xy. Enumerate them twice, first to count, then to fill.
+	auto forall_lower_triangles = [&](const auto&f){
+		for(unsigned z=0; z<node_count; ++z)
+			for(unsigned zx=s.first_out[z]; zx<s.first_out[z+1]; ++zx)
+				for(unsigned zy=zx+1; zy<s.first_out[z+1]; ++zy){
+					unsigned xy = s.find_arc(s.head[zx], s.head[zy]);
+					if(xy == CCHStructure::invalid_id)
+						throw std::runtime_error("The supergraph is not chordal");
+					f(xy, zx, zy);
+				}
+	};
+
+	const unsigned arc_count = s.head.size();
+	s.first_lower_triangle.assign(arc_count+1, 0);
+	forall_lower_triangles([&](unsigned xy, unsigned, unsigned){
+		++s.first_lower_triangle[xy+1];
+	});
+	for(unsigned xy=0; xy<arc_count; ++xy)
+		s.first_lower_triangle[xy+1] += s.first_lower_triangle[xy];
+
+	s.lower_triangle.resize(2*s.first_lower_triangle[arc_count]);
+	std::vector<std::uint64_t>next_lower_triangle(s.first_lower_triangle.begin(), s.first_lower_triangle.end()-1);
+	forall_lower_triangles([&](unsigned xy, unsigned zx, unsigned zy){
+		std::uint64_t i = next_lower_triangle[xy]++;
+		s.lower_triangle[2*i] = zx;
+		s.lower_triangle[2*i+1] = zy;
+	});
+
+	return s; // NVRO
+}
+
+namespace cch_structure_detail{
+	const char magic[8] = {'I', 'F', 'C', 'C', 'C', 'H', '\0', '\0'};
+
+	template<class T>
+	void write(std::ostream&out, const T*data, std::uint64_t count){
+		out.write(reinterpret_cast<const char*>(data), count*sizeof(T));
+	}
+
+	template<class T>
+	void read(std::istream&in, T*data, std::uint64_t count, const std::string&file_name){
+		in.read(reinterpret_cast<char*>(data), count*sizeof(T));
+		if(!in)
+			throw std::runtime_error("\""+file_name+"\" is truncated");
+	}
+}
+
+inline void save_cch_structure(const std::string&file_name, const CCHStructure&s){
+	using namespace cch_structure_detail;
+
+	std::ofstream out(file_name, std::ios::binary);
+	if(!out)
+		throw std::runtime_error("Can not open \""+file_name+"\" for writing.");
+
+	const std::uint32_t header[] = {CCHStructure::version, s.node_count(), s.arc_count(), 0};
+	const std::uint64_t triangle_count = s.triangle_count();
+	write(out, magic, 8);
+	write(out, header, 4);
+	write(out, &triangle_count, 1);
+	write(out, s.order.data(), s.order.size());
+	write(out, s.first_out.data(), s.first_out.size());
+	write(out, s.head.data(), s.head.size());
+	write(out, s.elimination_tree_parent.data(), s.elimination_tree_parent.size());
+	write(out, s.first_lower_triangle.data(), s.first_lower_triangle.size());
+	write(out, s.lower_triangle.data(), s.lower_triangle.size());
+
+	if(!out)
+		throw std::runtime_error("Can not write to \""+file_name+"\".");
+}
+
+//! Loads and validates a CCH structure. If load_triangles is false, then the lower
+//! triangles are skipped and their vectors stay empty.
+inline CCHStructure load_cch_structure(const std::string&file_name, bool load_triangles = true){
+	using namespace cch_structure_detail;
+
+	std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+	if(!in)
+		throw std::runtime_error("Can not open \""+file_name+"\" for reading.");
+	const std::uint64_t file_size = in.tellg();
+	in.seekg(0);
+
+	char file_magic[8];
+	std::uint32_t header[4];
+	std::uint64_t triangle_count;
+	read(in, file_magic, 8, file_name);
+	if(std::memcmp(file_magic, magic, 8) != 0)
+		throw std::runtime_error("\""+file_name+"\" is no CCH structure file");
+	read(in, header, 4, file_name);
+	if(header[0] != CCHStructure::version)
+		throw std::runtime_error("\""+file_name+"\" has the unsupported version "+std::to_string(header[0]));
+	read(in, &triangle_count, 1, file_name);
+
+	const std::uint32_t node_count = header[1], arc_count = header[2];
+
+	auto check = [&](bool ok){
+		if(!ok)
+			throw std::runtime_error("\""+file_name+"\" is corrupt");
+	};
+
+	// The counts must match the file size before anything is allocated. A rank must
+	// be below invalid_id, which also keeps node_count+1 from overflowing.
+	check(node_count < CCHStructure::invalid_id && arc_count < CCHStructure::invalid_id);
+	const std::uint64_t header_size = 8 + 4*4 + 8;
+	const std::uint64_t fixed_size = header_size + 4*(3*std::uint64_t(node_count)+1) + 4*std::uint64_t(arc_count) + 8*(std::uint64_t(arc_count)+1);
+	check(fixed_size <= file_size);
+	const std::uint64_t triangle_size = file_size - fixed_size;
+	check(triangle_size % 8 == 0 && triangle_count == triangle_size / 8);
+
+	CCHStructure s;
+	s.order.resize(node_count);
+	s.first_out.resize(node_count+1);
+	s.head.resize(arc_count);
+	s.elimination_tree_parent.resize(node_count);
+	read(in, s.order.data(), s.order.size(), file_name);
+	read(in, s.first_out.data(), s.first_out.size(), file_name);
+	read(in, s.head.data(), s.head.size(), file_name);
+	read(in, s.elimination_tree_parent.data(), s.elimination_tree_parent.size(), file_name);
+
+	check(s.first_out[0] == 0 && s.first_out[node_count] == arc_count);
+	for(unsigned x=0; x<node_count; ++x){
+		check(s.order[x] < node_count);
+		check(s.first_out[x] <= s.first_out[x+1]);
+		for(unsigned xy=s.first_out[x]; xy<s.first_out[x+1]; ++xy)
+			check(x < s.head[xy] && s.head[xy] < node_count && (xy == s.first_out[x] || s.head[xy-1] < s.head[xy]));
+		check(s.elimination_tree_parent[x] == (s.first_out[x] == s.first_out[x+1] ? CCHStructure::invalid_id : s.head[s.first_out[x]]));
+	}
+
+	if(load_triangles){
+		s.first_lower_triangle.resize(arc_count+1);
+		s.lower_triangle.resize(2*triangle_count);
+		read(in, s.first_lower_triangle.data(), s.first_lower_triangle.size(), file_name);
+		read(in, s.lower_triangle.data(), s.lower_triangle.size(), file_name);
+		check(s.first_lower_triangle[0] == 0 && s.first_lower_triangle[arc_count] == triangle_count);
+		for(unsigned xy=0; xy<arc_count; ++xy)
+			check(s.first_lower_triangle[xy] <= s.first_lower_triangle[xy+1]);
+		for(auto a:s.lower_triangle)
+			check(a < arc_count);
+	}
+
+	return s; // NVRO
+}
+
+#endif
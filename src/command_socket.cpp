@@ -0,0 +1,193 @@
+#include "command_socket.h"
+
+#include <iostream>
+#include <streambuf>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace{
+	//! Closes the file descriptor when going out of scope.
+	class FileDescriptor{
+	public:
+		explicit FileDescriptor(int fd):fd(fd){}
+		~FileDescriptor(){
+			if(fd != -1)
+				::close(fd);
+		}
+		FileDescriptor(const FileDescriptor&) = delete;
+		FileDescriptor&operator=(const FileDescriptor&) = delete;
+
+		int get()const{
+			return fd;
+		}
+	private:
+		int fd;
+	};
+
+	//! Removes a socket that a previous server left behind at socket_path. Anything
+	//! else at that path is left untouched and reported as error.
+	void remove_stale_socket(const std::string&socket_path){
+		struct stat s;
+		if(::lstat(socket_path.c_str(), &s) != 0){
+			if(errno == ENOENT)
+				return;
+			throw std::runtime_error("Could not stat "+socket_path+": "+std::string(std::strerror(errno)));
+		}
+		if(!S_ISSOCK(s.st_mode))
+			throw std::runtime_error(socket_path+" exists and is not a socket");
+		::unlink(socket_path.c_str());
+	}
+
+	//! Writes everything to a socket. If the client went away, then the output is
+	//! dropped instead of raising SIGPIPE, such that the server survives.
+	class SocketStreamBuf : public std::streambuf{
+	public:
+		explicit SocketStreamBuf(int fd):fd(fd), is_client_gone(false){
+			setp(buffer, buffer + sizeof(buffer));
+		}
+
+		~SocketStreamBuf(){
+			sync();
+		}
+
+		bool was_client_lost()const{
+			return is_client_gone;
+		}
+
+	protected:
+		int_type overflow(int_type c)override{
+			flush_buffer();
+			if(c != traits_type::eof()){
+				*pptr() = traits_type::to_char_type(c);
+				pbump(1);
+			}
+			return traits_type::not_eof(c);
+		}
+
+		int sync()override{
+			flush_buffer();
+			return 0;
+		}
+
+	private:
+		void flush_buffer(){
+			const char*pos = pbase();
+			while(pos != pptr() && !is_client_gone){
+				ssize_t written = ::send(fd, pos, pptr() - pos, MSG_NOSIGNAL);
+				if(written < 0){
+					if(errno == EINTR)
+						continue;
+					is_client_gone = true;
+				}else{
+					pos += written;
+				}
+			}
+			setp(buffer, buffer + sizeof(buffer));
+		}
+
+		int fd;
+		bool is_client_gone;
+		char buffer[1<<16];
+	};
+
+	//! Reads a client line by line.
+	class LineReader{
+	public:
+		explicit LineReader(int fd):fd(fd){}
+
+		bool get_line(std::string&line){
+			for(;;){
+				auto line_end = pending.find('\n');
+				if(line_end != std::string::npos){
+					line = pending.substr(0, line_end);
+					pending.erase(0, line_end+1);
+					if(!line.empty() && line.back() == '\r')
+						line.pop_back();
+					return true;
+				}
+
+				char buffer[4096];
+				ssize_t read = ::recv(fd, buffer, sizeof(buffer), 0);
+				if(read < 0 && errno == EINTR)
+					continue;
+				if(read <= 0){
+					if(pending.empty())
+						return false;
+					line = std::move(pending);
+					pending.clear();
+					return true;
+				}
+				pending.append(buffer, read);
+			}
+		}
+
+	private:
+		int fd;
+		std::string pending;
+	};
+
+	//! Runs process_line with std::cout redirected to the client and restores
+	//! std::cout afterwards, even if process_line throws.
+	class RedirectCout{
+	public:
+		explicit RedirectCout(std::streambuf*buf):old_buf(std::cout.rdbuf(buf)){}
+		~RedirectCout(){
+			std::cout.flush();
+			std::cout.rdbuf(old_buf);
+		}
+	private:
+		std::streambuf*old_buf;
+	};
+}
+
+void serve_command_lines(const std::string&socket_path, const std::function<bool(const std::string&)>&process_line){
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path))
+		throw std::runtime_error("The socket path \""+socket_path+"\" is empty or too long");
+	std::memcpy(addr.sun_path, socket_path.data(), socket_path.size());
+
+	FileDescriptor server(::socket(AF_UNIX, SOCK_STREAM, 0));
+	if(server.get() == -1)
+		throw std::runtime_error("Could not create a socket: "+std::string(std::strerror(errno)));
+
+	remove_stale_socket(socket_path);
+	if(::bind(server.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+		throw std::runtime_error("Could not bind to "+socket_path+": "+std::string(std::strerror(errno)));
+	if(::listen(server.get(), 16) != 0)
+		throw std::runtime_error("Could not listen on "+socket_path+": "+std::string(std::strerror(errno)));
+
+	std::cout << "Listening on " << socket_path << std::endl;
+
+	bool keep_serving = true;
+	while(keep_serving){
+		FileDescriptor client(::accept(server.get(), nullptr, nullptr));
+		if(client.get() == -1){
+			if(errno == EINTR || errno == ECONNABORTED)
+				continue;
+			::unlink(socket_path.c_str());
+			throw std::runtime_error("Could not accept a connection on "+socket_path+": "+std::string(std::strerror(errno)));
+		}
+
+		LineReader in(client.get());
+		SocketStreamBuf out(client.get());
+		std::string line;
+		while(keep_serving && !out.was_client_lost() && in.get_line(line)){
+			{
+				RedirectCout redirect(&out);
+				keep_serving = process_line(line);
+			}
+			out.sputc('\0');
+			out.pubsync();
+		}
+	}
+
+	::unlink(socket_path.c_str());
+}
@@ -0,0 +1,18 @@
+#ifndef COMMAND_SOCKET_H
+#define COMMAND_SOCKET_H
+
+#include <string>
+#include <functional>
+
+//! Listens on a Unix domain socket at socket_path and calls process_line for
+//! every line that a client sends. Clients are served one after another. While
+//! process_line runs, std::cout is redirected to the client. After each line a
+//! '\0' byte is sent, such that the client knows that the output is complete.
+//!
+//! A socket that a previous server left at socket_path is replaced. If the path
+//! holds anything else, such as a regular file, then an exception is thrown.
+//!
+//! The server stops and removes the socket file once process_line returns false.
+void serve_command_lines(const std::string&socket_path, const std::function<bool(const std::string&)>&process_line);
+
+#endif
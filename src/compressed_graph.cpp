@@ -0,0 +1,591 @@
+#include "compressed_graph.h"
+#include "sort_arc.h"
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+namespace{
+	const char magic[8] = {'I', 'F', 'C', 'C', 'G', 'R', '0', '1'};
+	const int section_name_size = 16;
+
+	//! The number of elements in a block. The blocks are the unit of parallelism.
+	const std::uint32_t block_size = 1<<16;
+
+	//! If set, then the values of a section are stored as differences to the
+	//! previous value in the same block.
+	const std::uint32_t delta_coded_flag = 1;
+
+	const double geo_pos_resolution = 1e7;
+
+	struct FileHeader{
+		char magic[8];
+		std::uint32_t section_count;
+		std::uint32_t reserved;
+	};
+
+	struct IndexEntry{
+		char name[section_name_size];
+		std::uint64_t offset;
+		std::uint64_t byte_count;
+	};
+
+	struct SectionHeader{
+		std::uint64_t element_count;
+		std::uint32_t block_size;
+		std::uint32_t flags;
+	};
+
+	inline std::uint64_t zigzag_encode(std::int64_t x){
+		return (static_cast<std::uint64_t>(x) << 1) ^ static_cast<std::uint64_t>(x >> 63);
+	}
+
+	inline std::int64_t zigzag_decode(std::uint64_t x){
+		return static_cast<std::int64_t>(x >> 1) ^ -static_cast<std::int64_t>(x & 1);
+	}
+
+	inline void append_varint(std::vector<unsigned char>&out, std::uint64_t x){
+		while(x >= 0x80){
+			out.push_back(static_cast<unsigned char>(x | 0x80));
+			x >>= 7;
+		}
+		out.push_back(static_cast<unsigned char>(x));
+	}
+
+	inline bool read_varint(const unsigned char*&pos, const unsigned char*end, std::uint64_t&x){
+		x = 0;
+		for(int shift=0; shift<64; shift+=7){
+			if(pos == end)
+				return false;
+			unsigned char c = *pos++;
+			x |= static_cast<std::uint64_t>(c & 0x7F) << shift;
+			if(!(c & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	//! Every block starts with a byte that says how its values are encoded.
+	const unsigned char varint_block = 0;
+	//! The block stores the minimum value as varint, followed by a byte with a bit
+	//! width w and the differences of all values to the minimum with w bits each.
+	const unsigned char bit_packed_block = 1;
+
+	int get_varint_size(std::uint64_t x){
+		int size = 1;
+		while(x >= 0x80){
+			x >>= 7;
+			++size;
+		}
+		return size;
+	}
+
+	int get_bit_width(std::uint64_t x){
+		int width = 0;
+		while(x != 0){
+			x >>= 1;
+			++width;
+		}
+		return width;
+	}
+
+	class BitWriter{
+	public:
+		explicit BitWriter(std::vector<unsigned char>&out):out(out), buffer(0), buffer_size(0){}
+
+		void write(std::uint64_t x, int width){
+			while(width > 0){
+				int part = std::min(width, 32);
+				buffer |= (x & ((std::uint64_t(1) << part) - 1)) << buffer_size;
+				buffer_size += part;
+				x >>= part;
+				width -= part;
+				while(buffer_size >= 8){
+					out.push_back(static_cast<unsigned char>(buffer));
+					buffer >>= 8;
+					buffer_size -= 8;
+				}
+			}
+		}
+
+		void flush(){
+			if(buffer_size > 0)
+				out.push_back(static_cast<unsigned char>(buffer));
+			buffer = 0;
+			buffer_size = 0;
+		}
+
+	private:
+		std::vector<unsigned char>&out;
+		std::uint64_t buffer;
+		int buffer_size;
+	};
+
+	class BitReader{
+	public:
+		BitReader(const unsigned char*pos, const unsigned char*end):pos(pos), end(end), buffer(0), buffer_size(0){}
+
+		bool read(std::uint64_t&x, int width){
+			x = 0;
+			int done = 0;
+			while(done < width){
+				int part = std::min(width - done, 32);
+				while(buffer_size < part){
+					if(pos == end)
+						return false;
+					buffer |= static_cast<std::uint64_t>(*pos++) << buffer_size;
+					buffer_size += 8;
+				}
+				x |= (buffer & ((std::uint64_t(1) << part) - 1)) << done;
+				buffer >>= part;
+				buffer_size -= part;
+				done += part;
+			}
+			return true;
+		}
+
+		const unsigned char*get_pos()const{
+			return pos;
+		}
+
+	private:
+		const unsigned char*pos, *end;
+		std::uint64_t buffer;
+		int buffer_size;
+	};
+
+	//! Encodes the values of a block with the encoding that needs less space.
+	void encode_block(std::vector<unsigned char>&out, const std::vector<std::int64_t>&value){
+		std::uint64_t varint_size = 0;
+		std::int64_t min_value = std::numeric_limits<std::int64_t>::max(), max_value = std::numeric_limits<std::int64_t>::min();
+		for(auto x:value){
+			varint_size += get_varint_size(zigzag_encode(x));
+			min_value = std::min(min_value, x);
+			max_value = std::max(max_value, x);
+		}
+
+		int width = value.empty() ? 0 : get_bit_width(static_cast<std::uint64_t>(max_value) - static_cast<std::uint64_t>(min_value));
+		std::uint64_t bit_packed_size = get_varint_size(zigzag_encode(min_value)) + 1 + (value.size()*width + 7) / 8;
+
+		if(varint_size <= bit_packed_size){
+			out.reserve(out.size() + 1 + varint_size);
+			out.push_back(varint_block);
+			for(auto x:value)
+				append_varint(out, zigzag_encode(x));
+		}else{
+			out.reserve(out.size() + 1 + bit_packed_size);
+			out.push_back(bit_packed_block);
+			append_varint(out, zigzag_encode(min_value));
+			out.push_back(static_cast<unsigned char>(width));
+			BitWriter writer(out);
+			for(auto x:value)
+				writer.write(static_cast<std::uint64_t>(x) - static_cast<std::uint64_t>(min_value), width);
+			writer.flush();
+		}
+	}
+
+	template<class T>
+	void append_raw(std::vector<unsigned char>&out, const T&x){
+		const unsigned char*begin = reinterpret_cast<const unsigned char*>(&x);
+		out.insert(out.end(), begin, begin + sizeof(x));
+	}
+
+	std::runtime_error corrupt_file_error(const std::string&file_name){
+		return std::runtime_error("Compressed graph file "+file_name+" is corrupt");
+	}
+
+	struct EncodedSection{
+		std::string name;
+		std::vector<unsigned char>data;
+	};
+
+	//! get_value(i) must return the i-th element as std::int64_t.
+	template<class GetValue>
+	EncodedSection encode_section(std::string name, std::uint64_t element_count, bool is_delta_coded, const GetValue&get_value){
+		assert(name.size() < static_cast<std::size_t>(section_name_size));
+
+		std::uint64_t block_count = (element_count + block_size - 1) / block_size;
+		std::vector<std::vector<unsigned char>>block(block_count);
+		tbb::parallel_for(std::uint64_t(0), block_count, [&](std::uint64_t b){
+			std::uint64_t begin = b*block_size, end = std::min(element_count, begin + block_size);
+			std::vector<std::int64_t>value(end - begin);
+			std::int64_t prev = 0;
+			for(std::uint64_t i=begin; i<end; ++i){
+				std::int64_t x = get_value(i);
+				value[i-begin] = is_delta_coded ? x - prev : x;
+				prev = x;
+			}
+			encode_block(block[b], value);
+		});
+
+		EncodedSection s;
+		s.name = std::move(name);
+		append_raw(s.data, SectionHeader{element_count, block_size, is_delta_coded ? delta_coded_flag : 0});
+		std::uint64_t byte_begin = 0;
+		for(auto&b:block){
+			append_raw(s.data, byte_begin);
+			byte_begin += b.size();
+		}
+		append_raw(s.data, byte_begin);
+		s.data.reserve(s.data.size() + byte_begin);
+		for(auto&b:block){
+			s.data.insert(s.data.end(), b.begin(), b.end());
+			std::vector<unsigned char>().swap(b);
+		}
+		return s; // NVRO
+	}
+
+	class SectionDecoder{
+	public:
+		SectionDecoder(std::string file_name, std::vector<unsigned char>data):
+			file_name(std::move(file_name)), data(std::move(data)){
+
+			if(this->data.size() < sizeof(SectionHeader))
+				throw corrupt_file_error(this->file_name);
+			std::memcpy(&header, this->data.data(), sizeof(header));
+			if(header.block_size == 0 || (header.flags & ~delta_coded_flag) != 0)
+				throw corrupt_file_error(this->file_name);
+
+			block_count = header.element_count / header.block_size + (header.element_count % header.block_size != 0);
+			std::uint64_t offset_table_size = (block_count+1)*sizeof(std::uint64_t);
+			if(block_count >= this->data.size() || this->data.size() - sizeof(SectionHeader) < offset_table_size)
+				throw corrupt_file_error(this->file_name);
+			block_byte_begin.resize(block_count+1);
+			std::memcpy(block_byte_begin.data(), this->data.data() + sizeof(SectionHeader), offset_table_size);
+			payload_begin = sizeof(SectionHeader) + offset_table_size;
+
+			if(block_byte_begin[0] != 0 || block_byte_begin[block_count] != this->data.size() - payload_begin)
+				throw corrupt_file_error(this->file_name);
+			for(std::uint64_t b=0; b<block_count; ++b)
+				if(block_byte_begin[b] > block_byte_begin[b+1])
+					throw corrupt_file_error(this->file_name);
+		}
+
+		std::uint64_t get_element_count()const{
+			return header.element_count;
+		}
+
+		//! Calls set_value(i, x) with the i-th element x as std::int64_t. The calls for
+		//! different blocks are made concurrently.
+		template<class SetValue>
+		void decode(const SetValue&set_value)const{
+			const bool is_delta_coded = (header.flags & delta_coded_flag) != 0;
+			tbb::parallel_for(std::uint64_t(0), block_count, [&](std::uint64_t b){
+				const unsigned char
+					*pos = data.data() + payload_begin + block_byte_begin[b],
+					*end = data.data() + payload_begin + block_byte_begin[b+1];
+				std::uint64_t begin = b*header.block_size, element_end = std::min(header.element_count, begin + header.block_size);
+				if(pos == end)
+					throw corrupt_file_error(file_name);
+				const unsigned char encoding = *pos++;
+
+				std::int64_t prev = 0;
+				auto set_next_value = [&](std::uint64_t i, std::int64_t value){
+					if(is_delta_coded){
+						value = static_cast<std::int64_t>(static_cast<std::uint64_t>(value) + static_cast<std::uint64_t>(prev));
+						prev = value;
+					}
+					set_value(i, value);
+				};
+
+				if(encoding == varint_block){
+					for(std::uint64_t i=begin; i<element_end; ++i){
+						std::uint64_t x;
+						if(!read_varint(pos, end, x))
+							throw corrupt_file_error(file_name);
+						set_next_value(i, zigzag_decode(x));
+					}
+				}else if(encoding == bit_packed_block){
+					std::uint64_t min_value;
+					if(!read_varint(pos, end, min_value) || pos == end || *pos > 64)
+						throw corrupt_file_error(file_name);
+					const int width = *pos++;
+					BitReader reader(pos, end);
+					for(std::uint64_t i=begin; i<element_end; ++i){
+						std::uint64_t x;
+						if(!reader.read(x, width))
+							throw corrupt_file_error(file_name);
+						set_next_value(i, static_cast<std::int64_t>(x + static_cast<std::uint64_t>(zigzag_decode(min_value))));
+					}
+					pos = reader.get_pos();
+				}else{
+					throw corrupt_file_error(file_name);
+				}
+				if(pos != end)
+					throw corrupt_file_error(file_name);
+			});
+		}
+
+	private:
+		std::string file_name;
+		std::vector<unsigned char>data;
+		SectionHeader header;
+		std::uint64_t block_count;
+		std::vector<std::uint64_t>block_byte_begin;
+		std::uint64_t payload_begin;
+	};
+
+	class CompressedGraphFile{
+	public:
+		explicit CompressedGraphFile(const std::string&file_name):
+			file_name(file_name), in(file_name, std::ios::binary){
+			if(!in)
+				throw std::runtime_error("Could not load "+file_name+" for binary reading");
+
+			FileHeader header;
+			if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+				throw std::runtime_error(file_name+" is no compressed graph file");
+
+			in.seekg(0, in.end);
+			std::uint64_t file_size = in.tellg();
+			in.seekg(sizeof(header), in.beg);
+
+			if(header.section_count > (file_size - sizeof(header)) / sizeof(IndexEntry))
+				throw corrupt_file_error(file_name);
+			index.resize(header.section_count);
+			if(!in.read(reinterpret_cast<char*>(index.data()), index.size()*sizeof(IndexEntry)))
+				throw corrupt_file_error(file_name);
+			for(auto&e:index)
+				if(e.name[section_name_size-1] != '\0' || e.offset > file_size || e.byte_count > file_size - e.offset)
+					throw corrupt_file_error(file_name);
+		}
+
+		//! Only reads the header of the section.
+		std::uint64_t get_element_count(const std::string&name){
+			return read_section_header(get_section(name)).element_count;
+		}
+
+		SectionDecoder read_section(const std::string&name){
+			const IndexEntry&e = get_section(name);
+			std::vector<unsigned char>data(e.byte_count);
+			in.seekg(e.offset, in.beg);
+			if(!in.read(reinterpret_cast<char*>(data.data()), data.size()))
+				throw corrupt_file_error(file_name);
+			return SectionDecoder(file_name, std::move(data));
+		}
+
+		std::vector<CompressedGraphSection> examine(){
+			std::vector<CompressedGraphSection>result;
+			for(auto&e:index)
+				result.push_back({e.name, static_cast<long long>(read_section_header(e).element_count), static_cast<long long>(e.byte_count)});
+			return result; // NVRO
+		}
+
+	private:
+		const IndexEntry&get_section(const std::string&name)const{
+			for(auto&e:index)
+				if(name == e.name)
+					return e;
+			throw std::runtime_error("Compressed graph file "+file_name+" has no "+name+" section");
+		}
+
+		SectionHeader read_section_header(const IndexEntry&e){
+			SectionHeader h;
+			if(e.byte_count < sizeof(h))
+				throw corrupt_file_error(file_name);
+			in.seekg(e.offset, in.beg);
+			if(!in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+				throw corrupt_file_error(file_name);
+			return h;
+		}
+
+		std::string file_name;
+		std::ifstream in;
+		std::vector<IndexEntry>index;
+	};
+
+	int to_int_count(const std::string&file_name, std::uint64_t count){
+		if(count > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+			throw corrupt_file_error(file_name);
+		return static_cast<int>(count);
+	}
+
+	bool is_int(std::int64_t x){
+		return std::numeric_limits<int>::min() <= x && x <= std::numeric_limits<int>::max();
+	}
+
+	ArrayIDFunc<int> decode_int_section(const std::string&file_name, const SectionDecoder&section){
+		ArrayIDFunc<int>result(to_int_count(file_name, section.get_element_count()));
+		section.decode([&](std::uint64_t i, std::int64_t x){
+			if(!is_int(x))
+				throw corrupt_file_error(file_name);
+			result[i] = static_cast<int>(x);
+		});
+		return result; // NVRO
+	}
+
+	ArrayIDFunc<int> load_int_section(const std::string&file_name, CompressedGraphFile&file, const std::string&name, int expected_element_count){
+		auto result = decode_int_section(file_name, file.read_section(name));
+		if(expected_element_count != -1 && result.preimage_count() != expected_element_count)
+			throw corrupt_file_error(file_name);
+		return result; // NVRO
+	}
+
+	int load_node_count(const std::string&file_name, CompressedGraphFile&file){
+		return to_int_count(file_name, file.get_element_count("degree"));
+	}
+}
+
+void save_compressed_graph(
+	const std::string&file_name,
+	const ArrayIDIDFunc&tail, const ArrayIDIDFunc&head,
+	const ArrayIDFunc<int>&node_weight, const ArrayIDFunc<int>&arc_weight,
+	const ArrayIDFunc<GeoPos>&geo_pos
+){
+	const int node_count = tail.image_count();
+	const int arc_count = tail.preimage_count();
+
+	assert(head.preimage_count() == arc_count && head.image_count() == node_count);
+	assert(node_weight.preimage_count() == node_count);
+	assert(arc_weight.preimage_count() == arc_count);
+	assert(geo_pos.preimage_count() == node_count);
+
+	// Arc i of the file is arc sorted_arc(i) of the graph.
+	ArrayIDIDFunc sorted_arc = sort_arcs_first_by_tail_second_by_head(tail, head);
+
+	ArrayIDFunc<int>degree(node_count);
+	degree.fill(0);
+	for(int i=0; i<arc_count; ++i)
+		++degree[tail(i)];
+
+	std::vector<EncodedSection>section;
+	section.push_back(encode_section("degree", node_count, false, [&](std::uint64_t x)->std::int64_t{
+		return degree(x);
+	}));
+	section.push_back(encode_section("head", arc_count, false, [&](std::uint64_t i)->std::int64_t{
+		int xy = sorted_arc(i);
+		int x = tail(xy), y = head(xy);
+		if(i == 0 || tail(sorted_arc(i-1)) != x)
+			return static_cast<std::int64_t>(y) - x;
+		else
+			return static_cast<std::int64_t>(y) - head(sorted_arc(i-1));
+	}));
+	section.push_back(encode_section("node_weight", node_count, false, [&](std::uint64_t x)->std::int64_t{
+		return node_weight(x);
+	}));
+	section.push_back(encode_section("arc_weight", arc_count, false, [&](std::uint64_t i)->std::int64_t{
+		return arc_weight(sorted_arc(i));
+	}));
+	section.push_back(encode_section("latitude", node_count, true, [&](std::uint64_t x)->std::int64_t{
+		return std::llround(geo_pos(x).lat * geo_pos_resolution);
+	}));
+	section.push_back(encode_section("longitude", node_count, true, [&](std::uint64_t x)->std::int64_t{
+		return std::llround(geo_pos(x).lon * geo_pos_resolution);
+	}));
+
+	FileHeader header;
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.section_count = section.size();
+	header.reserved = 0;
+
+	std::vector<IndexEntry>index(section.size());
+	std::uint64_t offset = sizeof(FileHeader) + section.size()*sizeof(IndexEntry);
+	for(unsigned i=0; i<section.size(); ++i){
+		std::memset(index[i].name, 0, section_name_size);
+		std::memcpy(index[i].name, section[i].name.data(), section[i].name.size());
+		index[i].offset = offset;
+		index[i].byte_count = section[i].data.size();
+		offset += section[i].data.size();
+	}
+
+	std::ofstream out(file_name, std::ios::binary);
+	if(!out)
+		throw std::runtime_error("Could not open "+file_name+" for binary writing");
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(index.data()), index.size()*sizeof(IndexEntry));
+	for(auto&s:section)
+		out.write(reinterpret_cast<const char*>(s.data.data()), s.data.size());
+	if(!out)
+		throw std::runtime_error("Could not write to "+file_name);
+}
+
+ListGraph load_compressed_graph(const std::string&file_name){
+	CompressedGraphFile file(file_name);
+
+	ArrayIDFunc<int>degree = load_int_section(file_name, file, "degree", -1);
+	const int node_count = degree.preimage_count();
+
+	std::vector<long long>first_out(node_count+1);
+	first_out[0] = 0;
+	for(int x=0; x<node_count; ++x){
+		if(degree(x) < 0)
+			throw corrupt_file_error(file_name);
+		first_out[x+1] = first_out[x] + degree(x);
+	}
+
+	SectionDecoder head_section = file.read_section("head");
+	if(head_section.get_element_count() != static_cast<std::uint64_t>(first_out[node_count]))
+		throw corrupt_file_error(file_name);
+	const int arc_count = to_int_count(file_name, head_section.get_element_count());
+
+	ListGraph graph(node_count, arc_count);
+
+	head_section.decode([&](std::uint64_t i, std::int64_t x){
+		if(!is_int(x))
+			throw corrupt_file_error(file_name);
+		graph.head[i] = static_cast<int>(x);
+	});
+
+	tbb::parallel_for(tbb::blocked_range<int>(0, node_count), [&](const tbb::blocked_range<int>&r){
+		for(int x=r.begin(); x<r.end(); ++x){
+			long long prev = x;
+			for(long long xy=first_out[x]; xy<first_out[x+1]; ++xy){
+				long long y = prev + graph.head[xy];
+				if(y < 0 || y >= node_count)
+					throw corrupt_file_error(file_name);
+				graph.tail[xy] = x;
+				graph.head[xy] = y;
+				prev = y;
+			}
+		}
+	});
+
+	graph.node_weight = load_int_section(file_name, file, "node_weight", node_count);
+	graph.arc_weight = load_int_section(file_name, file, "arc_weight", arc_count);
+
+	return graph; // NVRO
+}
+
+ArrayIDFunc<int> load_compressed_graph_node_weight(const std::string&file_name){
+	CompressedGraphFile file(file_name);
+	return load_int_section(file_name, file, "node_weight", load_node_count(file_name, file));
+}
+
+ArrayIDFunc<int> load_compressed_graph_arc_weight(const std::string&file_name){
+	CompressedGraphFile file(file_name);
+	return load_int_section(file_name, file, "arc_weight", -1);
+}
+
+ArrayIDFunc<GeoPos> load_compressed_graph_geo_pos(const std::string&file_name){
+	CompressedGraphFile file(file_name);
+	const int node_count = load_node_count(file_name, file);
+
+	ArrayIDFunc<GeoPos>geo_pos(node_count);
+
+	SectionDecoder lat = file.read_section("latitude");
+	if(lat.get_element_count() != static_cast<std::uint64_t>(node_count))
+		throw corrupt_file_error(file_name);
+	lat.decode([&](std::uint64_t x, std::int64_t v){
+		geo_pos[x].lat = v / geo_pos_resolution;
+	});
+
+	SectionDecoder lon = file.read_section("longitude");
+	if(lon.get_element_count() != static_cast<std::uint64_t>(node_count))
+		throw corrupt_file_error(file_name);
+	lon.decode([&](std::uint64_t x, std::int64_t v){
+		geo_pos[x].lon = v / geo_pos_resolution;
+	});
+
+	return geo_pos; // NVRO
+}
+
+std::vector<CompressedGraphSection> examine_compressed_graph(const std::string&file_name){
+	return CompressedGraphFile(file_name).examine();
+}
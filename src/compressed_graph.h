@@ -0,0 +1,45 @@
+#ifndef COMPRESSED_GRAPH_H
+#define COMPRESSED_GRAPH_H
+
+#include "array_id_func.h"
+#include "list_graph.h"
+#include "geo_pos.h"
+
+#include <string>
+#include <vector>
+
+//! A single file that stores a graph together with its weights and coordinates.
+//!
+//! The file starts with a section index, such that every array can be loaded on
+//! its own. Every section stores a sequence of integers, which is split into blocks
+//! that are encoded and decoded in parallel. A block is stored either as zigzag
+//! varints or bit-packed relative to its minimum, whichever is smaller. The arcs are
+//! stored sorted first by tail and second by head. The head of an arc is stored as
+//! the difference to the head of the previous arc of the same tail, or to the tail
+//! for the first arc. The coordinates are stored as fixed-point integers with a
+//! resolution of 1e-7 degrees as differences to the previous node in their block.
+//!
+//! A loaded graph therefore has its arcs sorted by tail and head, even if the
+//! saved graph did not, and coordinates are rounded to 1e-7 degrees.
+
+void save_compressed_graph(
+	const std::string&file_name,
+	const ArrayIDIDFunc&tail, const ArrayIDIDFunc&head,
+	const ArrayIDFunc<int>&node_weight, const ArrayIDFunc<int>&arc_weight,
+	const ArrayIDFunc<GeoPos>&geo_pos
+);
+
+ListGraph load_compressed_graph(const std::string&file_name);
+ArrayIDFunc<int> load_compressed_graph_node_weight(const std::string&file_name);
+ArrayIDFunc<int> load_compressed_graph_arc_weight(const std::string&file_name);
+ArrayIDFunc<GeoPos> load_compressed_graph_geo_pos(const std::string&file_name);
+
+struct CompressedGraphSection{
+	std::string name;
+	long long element_count;
+	long long byte_count;
+};
+
+std::vector<CompressedGraphSection> examine_compressed_graph(const std::string&file_name);
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef CONCURRENT_BEST_CUT_H
+#define CONCURRENT_BEST_CUT_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace flow_cutter{
+
+	//! A copy of the current cut of a cutter. It provides the part of the cutter
+	//! interface that expanded_graph::extract_original_separator_from_cut needs.
+	struct CutSnapshot{
+		CutSnapshot():smaller_cut_side_size(0){}
+
+		template<class Cutter>
+		explicit CutSnapshot(const Cutter&cutter):
+			cut(cutter.get_current_cut()),
+			smaller_cut_side_size(cutter.get_current_smaller_cut_side_size()){}
+
+		const std::vector<int>&get_current_cut()const{
+			return cut;
+		}
+
+		int get_current_smaller_cut_side_size()const{
+			return smaller_cut_side_size;
+		}
+
+		std::vector<int>cut;
+		int smaller_cut_side_size;
+	};
+
+	//! Keeps the cut with the smallest key among the cuts reported by concurrently
+	//! running cutters. An improving cut is published with a compare-and-swap and
+	//! without locking. Hence, the reporting threads should only copy what is needed
+	//! and the expensive processing should be done after the enumeration. Replaced
+	//! cuts are freed in the destructor, as other threads may still read their keys.
+	template<class Key, class Cut>
+	class ConcurrentBestCut{
+	public:
+		//! The initial key is the key of an empty cut. Only cuts with smaller keys are published.
+		explicit ConcurrentBestCut(Key initial_key):
+			best(new Node{std::move(initial_key), Cut(), nullptr}){}
+
+		ConcurrentBestCut(const ConcurrentBestCut&) = delete;
+		ConcurrentBestCut& operator=(const ConcurrentBestCut&) = delete;
+
+		~ConcurrentBestCut(){
+			const Node*n = best.load(std::memory_order_acquire);
+			while(n != nullptr){
+				const Node*replaced = n->replaced;
+				delete n;
+				n = replaced;
+			}
+		}
+
+		//! The cut is only created by make_cut() if key is smaller than the current best
+		//! key. Returns whether the cut was published.
+		template<class MakeCut>
+		bool try_publish(const Key&key, const MakeCut&make_cut){
+			const Node*current = best.load(std::memory_order_acquire);
+			if(!(key < current->key))
+				return false;
+			std::unique_ptr<Node>n(new Node{key, make_cut(), current});
+			while(key < current->key){
+				n->replaced = current;
+				if(best.compare_exchange_weak(current, n.get(), std::memory_order_acq_rel, std::memory_order_acquire)){
+					n.release();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool was_cut_published()const{
+			return best.load(std::memory_order_acquire)->replaced != nullptr;
+		}
+
+		const Key&get_best_key()const{
+			return best.load(std::memory_order_acquire)->key;
+		}
+
+		//! Must not be called concurrently with try_publish.
+		const Cut&get_best_cut()const{
+			return best.load(std::memory_order_acquire)->cut;
+		}
+
+	private:
+		struct Node{
+			Key key;
+			Cut cut;
+			const Node*replaced;
+		};
+
+		std::atomic<const Node*>best;
+	};
+}
+
+#endif
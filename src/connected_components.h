@@ -10,6 +10,15 @@
 
 #include <iterator>
 #include <limits>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_scan.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/enumerable_thread_specific.h>
 
 template<class Tail, class Head>
 ArrayIDIDFunc compute_connected_components(const Tail&tail, const Head&head){
@@ -286,6 +295,365 @@ ArrayIDIDFunc compute_biconnected_components(
 	return arc_component; // NVRO
 }
 
+//! Computes the same partition of the arcs into biconnected components as
+//! compute_biconnected_components, but in parallel. The graph must be symmetric
+//! and must not contain loops.
+//!
+//! Depth first search is inherently sequential. The function therefore works on a
+//! breadth first search forest instead, whose levels are processed in parallel.
+//! On this forest, it computes the preorder ids and, for every subtree, the lowest
+//! and highest preorder id that is reachable with a single non-tree arc from
+//! within the subtree. A tree arc from p to v is a fence, if no non-tree arc leaves
+//! the subtree of p from within the subtree of v. The biconnected components are
+//! the connected components of the graph without the fences and without the
+//! non-tree arcs between ancestors and descendants. These are computed with a
+//! concurrent union find. A tree arc belongs to the component of its lower node
+//! and a non-tree arc to the component of its endpoint with the larger preorder id.
+//!
+//! The components are numbered by their smallest arc id, such that the result does
+//! not depend on the thread count. The numbering in general differs from the one of
+//! compute_biconnected_components.
+template<
+	class OutArc, class Head, class BackArc
+>
+ArrayIDIDFunc compute_biconnected_components_in_parallel(
+	const OutArc&out_arc, const Head&head, const BackArc&back_arc
+){
+	const int node_count = out_arc.preimage_count();
+	const int arc_count = head.preimage_count();
+
+	// Small levels are not worth the scheduling overhead. Most levels of the
+	// breadth first search are small on a graph with many tiny components.
+	const int grain_size = 4096;
+
+	auto for_each_in_range = [&](int begin, int end, const auto&f){
+		if(end - begin <= grain_size){
+			for(int i=begin; i<end; ++i)
+				f(i);
+		}else{
+			tbb::parallel_for(tbb::blocked_range<int>(begin, end, grain_size), [&](const tbb::blocked_range<int>&r){
+				for(int i=r.begin(); i!=r.end(); ++i)
+					f(i);
+			});
+		}
+	};
+
+	// Calls set_sum(i, get_value(begin) + ... + get_value(i-1)) for every i in the
+	// range and returns the total sum.
+	auto exclusive_prefix_sum = [&](int begin, int end, const auto&get_value, const auto&set_sum){
+		if(end - begin <= grain_size){
+			int sum = 0;
+			for(int i=begin; i<end; ++i){
+				set_sum(i, sum);
+				sum += get_value(i);
+			}
+			return sum;
+		}else{
+			return tbb::parallel_scan(
+				tbb::blocked_range<int>(begin, end, grain_size), 0,
+				[&](const tbb::blocked_range<int>&range, int sum, bool is_final_scan){
+					for(int i=range.begin(); i!=range.end(); ++i){
+						if(is_final_scan)
+							set_sum(i, sum);
+						sum += get_value(i);
+					}
+					return sum;
+				},
+				[](int l, int r){ return l + r; }
+			);
+		}
+	};
+
+	// Build a breadth first search forest level by level. The node that discovers
+	// another node first becomes its parent. The forest is stored by position in
+	// the breadth first search order, such that the levels are ranges of positions
+	// and the children of a node are consecutive. The position and the arc towards
+	// the parent are stored by node.
+
+	struct NodeInfo{
+		int position;
+		int parent_arc;
+		int preorder_id;
+	};
+	ArrayIDFunc<NodeInfo>node_info(node_count);
+
+	std::unique_ptr<std::atomic<bool>[]>was_discovered(new std::atomic<bool>[node_count]);
+	for_each_in_range(0, node_count, [&](int x){ was_discovered[x].store(false, std::memory_order_relaxed); });
+
+	ArrayIDFunc<int>node_at(node_count), parent_position(node_count);
+	std::vector<int>level_begin;
+	int end_position = 0;
+
+	tbb::enumerable_thread_specific<std::vector<std::pair<int, int>>>next_level_buffer;
+
+	auto discover_children = [&](int i, const auto&push_back){
+		int x = node_at[i];
+		for(auto xy:out_arc(x)){
+			int y = head(xy);
+			if(!was_discovered[y].load(std::memory_order_relaxed) && !was_discovered[y].exchange(true)){
+				node_info[y].parent_arc = back_arc(xy);
+				push_back(y, i);
+			}
+		}
+	};
+
+	auto append = [&](int y, int p){
+		node_at[end_position] = y;
+		parent_position[end_position] = p;
+		node_info[y].position = end_position;
+		++end_position;
+	};
+
+	for(int r=0; r<node_count; ++r){
+		if(was_discovered[r].load(std::memory_order_relaxed))
+			continue;
+
+		was_discovered[r].store(true, std::memory_order_relaxed);
+		node_info[r].parent_arc = -1;
+		level_begin.push_back(end_position);
+		append(r, -1);
+
+		for(;;){
+			const int current_begin = level_begin.back();
+			const int current_end = end_position;
+
+			if(current_end - current_begin <= grain_size){
+				for(int i=current_begin; i<current_end; ++i)
+					discover_children(i, append);
+			}else{
+				for(auto&b:next_level_buffer)
+					b.clear();
+				tbb::parallel_for(tbb::blocked_range<int>(current_begin, current_end, grain_size), [&](const tbb::blocked_range<int>&range){
+					auto&out = next_level_buffer.local();
+					for(int i=range.begin(); i!=range.end(); ++i)
+						discover_children(i, [&](int y, int p){ out.push_back({y, p}); });
+				});
+				for(auto&b:next_level_buffer)
+					for(auto&y_and_p:b)
+						append(y_and_p.first, y_and_p.second);
+			}
+
+			if(end_position == current_end)
+				break;
+			level_begin.push_back(current_end);
+		}
+	}
+	assert(end_position == node_count);
+	was_discovered.reset();
+
+	const int level_count = level_begin.size();
+	level_begin.push_back(node_count);
+
+	auto is_root = [&](int i){
+		return parent_position[i] == -1;
+	};
+
+	// The children of the node at position i are at the positions child_begin[i]
+	// to child_end[i]-1.
+
+	ArrayIDFunc<int>child_begin(node_count), child_end(node_count);
+	for_each_in_range(0, node_count, [&](int i){
+		child_begin[i] = 0;
+		child_end[i] = 0;
+	});
+	for_each_in_range(0, node_count, [&](int i){
+		int p = parent_position[i];
+		if(p == -1)
+			return;
+		if(parent_position[i-1] != p)
+			child_begin[p] = i;
+		if(i == node_count-1 || parent_position[i+1] != p)
+			child_end[p] = i+1;
+	});
+
+	// Compute the subtree sizes bottom up.
+
+	ArrayIDFunc<int>subtree_size(node_count);
+	for(int l=level_count-1; l>=0; --l){
+		for_each_in_range(level_begin[l], level_begin[l+1], [&](int i){
+			int s = 1;
+			for(int j=child_begin[i]; j<child_end[i]; ++j)
+				s += subtree_size[j];
+			subtree_size[i] = s;
+		});
+	}
+
+	// Compute the preorder ids top down. The preorder id of a child is the one of
+	// its parent plus one plus the sizes of its left siblings. The latter follows
+	// from a prefix sum over the level.
+
+	ArrayIDFunc<int>preorder_id(node_count);
+	{
+		ArrayIDFunc<int>size_prefix_sum(node_count);
+		for(int l=0; l<level_count; ++l){
+			const int begin = level_begin[l];
+			const int end = level_begin[l+1];
+			if(is_root(begin)){
+				preorder_id[begin] = begin;
+			}else{
+				exclusive_prefix_sum(
+					begin, end,
+					[&](int i){ return subtree_size[i]; },
+					[&](int i, int sum){ size_prefix_sum[i] = sum; }
+				);
+				for_each_in_range(begin, end, [&](int i){
+					int p = parent_position[i];
+					preorder_id[i] = preorder_id[p] + 1 + size_prefix_sum[i] - size_prefix_sum[child_begin[p]];
+				});
+			}
+		}
+	}
+	for_each_in_range(0, node_count, [&](int i){
+		node_info[node_at[i]].preorder_id = preorder_id[i];
+	});
+
+	// Compute bottom up for every subtree the lowest and highest preorder id that is
+	// reachable with a single non-tree arc from within the subtree. On the way,
+	// store for every arc the position of its head and whether it is a non-tree
+	// arc between unrelated nodes, or leads to the lower endpoint of a tree arc, or
+	// to the endpoint with the larger preorder id of a non-tree arc. Later passes
+	// then read the arcs sequentially.
+
+	const unsigned char arc_leads_to_lower_endpoint = 1;
+	const unsigned char arc_connects_unrelated_nodes = 2;
+
+	ArrayIDFunc<int>arc_head_position(arc_count);
+	ArrayIDFunc<unsigned char>arc_flags(arc_count);
+
+	ArrayIDFunc<int>low(node_count), high(node_count);
+	for(int l=level_count-1; l>=0; --l){
+		for_each_in_range(level_begin[l], level_begin[l+1], [&](int i){
+			int x = node_at[i];
+			const int first = preorder_id[i];
+			const int last = first + subtree_size[i] - 1;
+			int lo = first;
+			int hi = first;
+			for(auto xy:out_arc(x)){
+				const NodeInfo y = node_info[head(xy)];
+				arc_head_position[xy] = y.position;
+				if(node_info[x].parent_arc == xy){
+					arc_flags[xy] = 0;
+				}else if(y.parent_arc == back_arc(xy)){
+					arc_flags[xy] = arc_leads_to_lower_endpoint;
+				}else{
+					lo = std::min(lo, y.preorder_id);
+					hi = std::max(hi, y.preorder_id);
+
+					// A non-tree arc of a breadth first search forest connects
+					// nodes whose levels differ by at most one. If these are
+					// related, then one is the parent of the other, which
+					// requires a multi-arc.
+					unsigned char flags = 0;
+					if(y.preorder_id > first)
+						flags |= arc_leads_to_lower_endpoint;
+					if(parent_position[i] != y.position && !(first <= y.preorder_id && y.preorder_id <= last))
+						flags |= arc_connects_unrelated_nodes;
+					arc_flags[xy] = flags;
+				}
+			}
+			for(int j=child_begin[i]; j<child_end[i]; ++j){
+				lo = std::min(lo, low[j]);
+				hi = std::max(hi, high[j]);
+			}
+			low[i] = lo;
+			high[i] = hi;
+		});
+	}
+
+	auto is_fence = [&](int i){
+		int p = parent_position[i];
+		return low[i] >= preorder_id[p] && high[i] < preorder_id[p] + subtree_size[p];
+	};
+
+	// Unite the positions along the tree arcs that are no fences and along the
+	// non-tree arcs between unrelated nodes. Roots are always linked below smaller
+	// positions, which keeps the union find acyclic.
+
+	std::unique_ptr<std::atomic<int>[]>representative(new std::atomic<int>[node_count]);
+	for_each_in_range(0, node_count, [&](int i){ representative[i].store(i, std::memory_order_relaxed); });
+
+	auto find = [&](int i){
+		for(;;){
+			int j = representative[i].load(std::memory_order_relaxed);
+			if(j == i)
+				return i;
+			int k = representative[j].load(std::memory_order_relaxed);
+			if(k != j)
+				representative[i].store(k, std::memory_order_relaxed);
+			i = j;
+		}
+	};
+
+	auto unite = [&](int i, int j){
+		for(;;){
+			i = find(i);
+			j = find(j);
+			if(i == j)
+				return;
+			if(i < j)
+				std::swap(i, j);
+			int expected = i;
+			if(representative[i].compare_exchange_strong(expected, j))
+				return;
+		}
+	};
+
+	for_each_in_range(0, node_count, [&](int i){
+		if(!is_root(i) && !is_fence(i))
+			unite(i, parent_position[i]);
+	});
+	for_each_in_range(0, node_count, [&](int x){
+		int i = node_info[x].position;
+		for(auto xy:out_arc(x)){
+			int j = arc_head_position[xy];
+			if(i < j && (arc_flags[xy] & arc_connects_unrelated_nodes))
+				unite(i, j);
+		}
+	});
+
+	// Assign the arcs to the components. These are numbered by their smallest arc
+	// id, as the representatives depend on the forest and thus on the scheduling.
+
+	ArrayIDIDFunc arc_component(arc_count, 0);
+	for_each_in_range(0, node_count, [&](int x){
+		int i = node_info[x].position;
+		for(auto xy:out_arc(x))
+			arc_component[xy] = find((arc_flags[xy] & arc_leads_to_lower_endpoint) ? arc_head_position[xy] : i);
+	});
+	arc_head_position = ArrayIDFunc<int>();
+	arc_flags = ArrayIDFunc<unsigned char>();
+
+	auto&first_arc = representative;
+	for_each_in_range(0, node_count, [&](int i){ first_arc[i].store(arc_count, std::memory_order_relaxed); });
+	for_each_in_range(0, arc_count, [&](int xy){
+		auto&f = first_arc[arc_component[xy]];
+		int current = f.load(std::memory_order_relaxed);
+		while(xy < current && !f.compare_exchange_weak(current, xy))
+			;
+	});
+
+	auto is_first_arc = [&](int xy){
+		return first_arc[arc_component[xy]].load(std::memory_order_relaxed) == xy;
+	};
+
+	ArrayIDFunc<int>component_id(node_count);
+	const int component_count = exclusive_prefix_sum(
+		0, arc_count,
+		[&](int xy){ return is_first_arc(xy) ? 1 : 0; },
+		[&](int xy, int id){
+			if(is_first_arc(xy))
+				component_id[arc_component[xy]] = id;
+		}
+	);
+
+	arc_component.set_image_count(component_count);
+	for_each_in_range(0, arc_count, [&](int xy){
+		arc_component[xy] = component_id[arc_component[xy]];
+	});
+
+	return arc_component; // NVRO
+}
+
 template<class Tail, class Head>
 bool is_biconnected(const Tail&tail, const Head&head){
 	return compute_biconnected_components(invert_id_id_func(tail), head, compute_back_arc_permutation(tail, head)).image_count() <= 1;
@@ -13,6 +13,8 @@
 #include "csv.h"
 #include "min_max.h"
 #include "contraction_graph.h"
+#include "elimination_tree.h"
+#include "cch_structure.h"
 #include "node_flow_cutter.h"
 #include "triangle_count.h"
 #include "separator.h"
@@ -22,6 +24,9 @@
 #include "min_fill_in.h"
 #include "inertial_flow.h"
 #include "list_graph.h"
+#include "compressed_graph.h"
+#include "command_socket.h"
+#include "graph_generator.h"
 
 #ifdef USE_KAHIP
 #include "my_kahip.h"
@@ -46,6 +51,14 @@ using namespace std;
 ArrayIDIDFunc tail, head;
 ArrayIDFunc<int>node_weight, arc_weight;
 
+// Incremented whenever tail or head is replaced or modified, such that data derived
+// from the graph can tell whether it is still up to date.
+unsigned long long graph_generation = 0;
+
+void mark_graph_changed(){
+	++graph_generation;
+}
+
 ArrayIDIDFunc node_color, arc_color;
 ArrayIDFunc<GeoPos> node_geo_pos;
 
@@ -77,6 +90,58 @@ void check_graph_consitency(){
 
 stack<ArrayIDIDFunc>node_color_stack;
 
+// The out arcs and back arcs of the graph are kept between commands, such that a
+// console that processes many commands on the same graph, see the serve command,
+// does not recompute them every time. They are recomputed if the graph generation
+// changed.
+struct DerivedGraphCache{
+	unsigned long long generation = 0;
+	bool is_out_arc_valid = false, is_back_arc_valid = false;
+	ArrayIDIDMultiFunc out_arc;
+	ArrayIDIDFunc back_arc;
+
+	void invalidate_if_graph_changed(){
+		if(generation != graph_generation){
+			generation = graph_generation;
+			is_out_arc_valid = false;
+			is_back_arc_valid = false;
+			out_arc = ArrayIDIDMultiFunc();
+			back_arc = ArrayIDIDFunc();
+		}
+	}
+}derived_graph_cache;
+
+const ArrayIDIDMultiFunc&get_out_arc(){
+	auto&c = derived_graph_cache;
+	c.invalidate_if_graph_changed();
+	if(!c.is_out_arc_valid){
+		c.out_arc = invert_id_id_func(tail);
+		c.is_out_arc_valid = true;
+	}
+	return c.out_arc;
+}
+
+const ArrayIDIDFunc&get_back_arc(){
+	auto&c = derived_graph_cache;
+	c.invalidate_if_graph_changed();
+	if(!c.is_back_arc_valid){
+		c.back_arc = compute_back_arc_permutation(tail, head);
+		c.is_back_arc_valid = true;
+	}
+	return c.back_arc;
+}
+
+// A copy of the graph that can be restored after commands that modified it, for
+// example to compute orders with different parameters on the same input.
+struct GraphSnapshot{
+	ArrayIDIDFunc tail, head;
+	ArrayIDFunc<int>node_weight, arc_weight;
+	ArrayIDIDFunc node_color, arc_color;
+	ArrayIDFunc<GeoPos> node_geo_pos;
+	ArrayIDIDFunc node_original_position, arc_original_position;
+};
+stack<GraphSnapshot>graph_snapshot_stack;
+
 flow_cutter::Config flow_cutter_config;
 
 bool show_arc_ids = false;
@@ -124,6 +189,7 @@ void permutate_nodes(const ArrayIDIDFunc&p){
 	auto inv_p = inverse_permutation(p);
 	head = chain(std::move(head), inv_p);
 	tail = chain(std::move(tail), inv_p);
+	mark_graph_changed();
 
 	node_color = chain(p, std::move(node_color));
 	node_geo_pos = chain(p, std::move(node_geo_pos));
@@ -136,6 +202,7 @@ void keep_arcs_if(const BitIDFunc&keep_flag){
 	int new_arc_count = count_true(keep_flag);
 	tail = keep_if(keep_flag, new_arc_count, move(tail));
 	head = keep_if(keep_flag, new_arc_count, move(head));
+	mark_graph_changed();
 	arc_weight = keep_if(keep_flag, new_arc_count, move(arc_weight));
 	arc_color = keep_if(keep_flag, new_arc_count, move(arc_color));
 	arc_original_position = keep_if(keep_flag, new_arc_count, std::move(arc_original_position));
@@ -145,11 +212,155 @@ static
 void permutate_arcs(const ArrayIDIDFunc&p){
 	tail = chain(p, move(tail));
 	head = chain(p, move(head));
+	mark_graph_changed();
 	arc_weight = chain(p, move(arc_weight));
 	arc_color = chain(p, move(arc_color));
 	arc_original_position = chain(p, std::move(arc_original_position));
 }
 
+static
+void replace_graph_by_generated_graph(GeneratedGraph g){
+	tail = std::move(g.tail);
+	head = std::move(g.head);
+	mark_graph_changed();
+	node_geo_pos = std::move(g.geo_pos);
+	node_weight = ArrayIDFunc<int>(tail.image_count());
+	node_weight.fill(1);
+	arc_weight = ArrayIDFunc<int>(tail.preimage_count());
+	arc_weight.fill(1);
+	arc_original_position = identity_permutation(tail.preimage_count());
+
+	node_color = ArrayIDIDFunc(tail.image_count(), 1);
+	node_color.fill(0);
+	node_original_position = identity_permutation(tail.image_count());
+	arc_color = ArrayIDIDFunc(tail.preimage_count(), 1);
+	arc_color.fill(0);
+}
+
+static
+uint64_t compute_order_checkpoint_fingerprint(){
+	cch_order::Hasher h;
+	h.add_id_func(tail);
+	h.add_id_func(head);
+	h.add_id_func(arc_weight);
+	h.add(node_geo_pos.preimage_count());
+	for(auto p:node_geo_pos){
+		h.add(p.lat);
+		h.add(p.lon);
+	}
+	// The order does not depend on the thread count. It may therefore change when resuming.
+	auto config = flow_cutter_config;
+	config.thread_count = 1;
+	h.add(config.get_config());
+	return h.get();
+}
+
+static
+void reorder_nodes_in_accelerated_flow_cutter_cch_order_with_checkpoint(const string&checkpoint_file, bool resume){
+	if(!is_symmetric(tail, head))
+		throw runtime_error("Graph must be symmetric");
+	if(has_multi_arcs(tail, head))
+		throw runtime_error("Graph must not have multi arcs");
+	if(!is_loop_free(tail, head))
+		throw runtime_error("Graph must not have loops");
+
+	ArrayIDIDFunc order;
+	{
+		cch_order::OrderCheckpoint checkpoint(checkpoint_file, compute_order_checkpoint_fingerprint(), resume);
+		if(resume)
+			cout << "Resuming with " << checkpoint.get_loaded_separator_count() << " separators and " << checkpoint.get_loaded_order_count() << " sub-orders from the checkpoint" << endl;
+
+		tbb::global_control gc(tbb::global_control::max_allowed_parallelism, flow_cutter_config.thread_count);
+		order = cch_order::compute_cch_graph_order(
+			tail, head, arc_weight,
+			flow_cutter::ComputeSeparator<flow_cutter_accelerated::CutterFactory, ArrayIDFunc<GeoPos>>(node_geo_pos, flow_cutter_config),
+			checkpoint
+		);
+		checkpoint.finish();
+	}
+	permutate_nodes(order);
+}
+
+// Separator hierarchies are saved with the node ids of the last loaded graph, such
+// that they remain valid if the nodes are reordered the same way after loading.
+static
+void reorder_nodes_in_accelerated_flow_cutter_cch_order_with_separator_hierarchy(const string&old_hierarchy_file, const string&new_hierarchy_file){
+	if(!is_symmetric(tail, head))
+		throw runtime_error("Graph must be symmetric");
+	if(has_multi_arcs(tail, head))
+		throw runtime_error("Graph must not have multi arcs");
+	if(!is_loop_free(tail, head))
+		throw runtime_error("Graph must not have loops");
+
+	const int node_count = tail.image_count();
+
+	cch_order::SeparatorHierarchy old_hierarchy(node_count);
+	if(!old_hierarchy_file.empty()){
+		old_hierarchy.load(old_hierarchy_file);
+		ArrayIDIDFunc loaded_to_current(node_original_position.image_count(), node_count);
+		loaded_to_current.fill(-1);
+		for(int x=0; x<node_count; ++x)
+			loaded_to_current[node_original_position(x)] = x;
+		old_hierarchy.relabel_nodes(
+			id_func(
+				old_hierarchy.get_node_count(),
+				[&](int x){
+					return x < loaded_to_current.preimage_count() ? loaded_to_current[x] : -1;
+				}
+			),
+			node_count
+		);
+	}
+	old_hierarchy.build_index();
+
+	cch_order::SeparatorHierarchy new_hierarchy(node_count);
+	cch_order::SeparatorHierarchyUpdate update(old_hierarchy, new_hierarchy, flow_cutter_config.max_imbalance);
+
+	ArrayIDIDFunc order;
+	{
+		tbb::global_control gc(tbb::global_control::max_allowed_parallelism, flow_cutter_config.thread_count);
+		order = cch_order::compute_cch_graph_order(
+			tail, head, arc_weight,
+			flow_cutter::ComputeSeparator<flow_cutter_accelerated::CutterFactory, ArrayIDFunc<GeoPos>>(node_geo_pos, flow_cutter_config),
+			update
+		);
+	}
+
+	if(!old_hierarchy_file.empty())
+		cout << "Reused " << update.reused_separator_count << " separators and computed " << update.computed_separator_count << " separators" << endl;
+
+	new_hierarchy.relabel_nodes(node_original_position, node_original_position.image_count());
+	new_hierarchy.save(new_hierarchy_file);
+
+	permutate_nodes(order);
+}
+
+static
+void reorder_nodes_in_accelerated_flow_cutter_cch_order_with_trace(const string&trace_file, int min_event_node_count){
+	if(!is_symmetric(tail, head))
+		throw runtime_error("Graph must be symmetric");
+	if(has_multi_arcs(tail, head))
+		throw runtime_error("Graph must not have multi arcs");
+	if(!is_loop_free(tail, head))
+		throw runtime_error("Graph must not have loops");
+
+	cch_order::OrderTrace trace(min_event_node_count);
+	ArrayIDIDFunc order;
+	{
+		tbb::global_control gc(tbb::global_control::max_allowed_parallelism, flow_cutter_config.thread_count);
+		order = cch_order::compute_cch_graph_order(
+			tail, head, arc_weight,
+			flow_cutter::ComputeSeparator<flow_cutter_accelerated::CutterFactory, ArrayIDFunc<GeoPos>>(node_geo_pos, flow_cutter_config),
+			trace
+		);
+	}
+
+	trace.print_level_summary(cout);
+	trace.save_chrome_trace(trace_file);
+
+	permutate_nodes(order);
+}
+
 struct Command{
 	string name;
 	int parameter_count;
@@ -172,6 +383,8 @@ struct Command{
 
 #include "fancy_input.h"
 
+bool execute_command_line(const string&line);
+
 auto w = setw(30);
 
 vector<Command>cmd = {
@@ -232,48 +445,54 @@ vector<Command>cmd = {
 			cmd_list.push_back("exit");
 			set_autocomplete_command_list(move(cmd_list));
 
-			while(get_command_line(line)){
-				try{
-					istringstream line_in(line);
-					string command;
-					line_in >> command;
-
-					if(command == "exit")
-						break;
-
-					int c = -1;
-					for(int i=0; i<(int)cmd.size(); ++i)
-						if(cmd[i].name == command){
-							c = i;
-							break;
-						}
-					if(c == -1)
-						throw runtime_error("Unknown command "+command);
-
-					vector<string>args;
-					string x;
-					while(line_in >> x)
-						args.push_back(x);
-					if((int)args.size() != cmd[c].parameter_count)
-						throw runtime_error("Wrong number of parameters to command "+cmd[c].name+". expected:"+to_string(cmd[c].parameter_count)+", got:"+to_string(args.size()));
-
-					auto prev_time_commands = time_commands;
-					long long time = -get_micro_time();
-					cmd[c].func(move(args));
-					time += get_micro_time();
-
-					if(time_commands && prev_time_commands){
-						cout << "running time : "<<time << "musec" << endl;
-					}
-
-					check_graph_consitency();
-				}catch(std::exception&err){
-					cout << "Exception : " << err.what() << endl;
-				}
-			}
+			while(get_command_line(line))
+				if(!execute_command_line(line))
+					break;
 			cout << endl;
 		}
 	},
+	{
+		"serve", 1,
+		"Keeps the graph in memory and processes command lines sent over the Unix domain socket arg1. Clients are served one after another. The output of every command line is terminated by a \\0 byte. The command exit stops the server.",
+		[](vector<string>args){
+			serve_command_lines(args[0], execute_command_line);
+		}
+	},
+	{
+		"push_graph_snapshot",
+		"Pushes a copy of the graph, its weights, colors, coordinates and original positions onto a stack.",
+		[]{
+			graph_snapshot_stack.push({tail, head, node_weight, arc_weight, node_color, arc_color, node_geo_pos, node_original_position, arc_original_position});
+		}
+	},
+	{
+		"restore_graph_snapshot",
+		"Replaces the graph by the snapshot on top of the stack without removing the snapshot.",
+		[]{
+			if(graph_snapshot_stack.empty())
+				throw runtime_error("There is no graph snapshot");
+			auto&s = graph_snapshot_stack.top();
+			tail = s.tail;
+			head = s.head;
+			mark_graph_changed();
+			node_weight = s.node_weight;
+			arc_weight = s.arc_weight;
+			node_color = s.node_color;
+			arc_color = s.arc_color;
+			node_geo_pos = s.node_geo_pos;
+			node_original_position = s.node_original_position;
+			arc_original_position = s.arc_original_position;
+		}
+	},
+	{
+		"pop_graph_snapshot",
+		"Removes the snapshot on top of the stack.",
+		[]{
+			if(graph_snapshot_stack.empty())
+				throw runtime_error("There is no graph snapshot");
+			graph_snapshot_stack.pop();
+		}
+	},
 	{
 		"report_time",
 		"Report the running time of every command",
@@ -299,55 +518,21 @@ vector<Command>cmd = {
 			if(node_count <= 1)
 				throw runtime_error("Graph must have at least 2 nodes");
 
-			int super_graph_arc_count = 0;
-			int current_tail = -1;
-			int current_tail_up_deg = 0;
+			auto elimination = compute_symbolic_elimination(tail, head);
+			const auto&parent = elimination.parent;
+			const auto&out_deg = elimination.upward_degree;
+
+			long long super_graph_arc_count = 0;
 			int max_up_deg = 0;
-			ArrayIDFunc<int>
-				out_deg(node_count),
-				parent(node_count);
-			out_deg.fill(0);
-			parent.fill(std::numeric_limits<int>::max());
-			compute_chordal_supergraph(
-				tail, head,
-				[&](int x, int y){
-					++out_deg[x];
-					if(current_tail != x){
-						current_tail = x;
-						max_to(max_up_deg, current_tail_up_deg);
-						current_tail_up_deg = 0;
-					}
-					++super_graph_arc_count;
-					++current_tail_up_deg;
-					min_to(parent[x], y);
-				}
-			);
+			for(auto d:out_deg){
+				super_graph_arc_count += d;
+				max_to(max_up_deg, d);
+			}
 
+			// A parent has a larger ID than its children.
 			ArrayIDFunc<int>ancestor_count(node_count);
-			ancestor_count.fill(-1);
-
-			for(int x=0; x<node_count; ++x){
-				if(ancestor_count(x) == -1){
-					int n = 0;
-					for(int y = x; y != std::numeric_limits<int>::max(); y = parent(y)){
-						if(ancestor_count(y) == -1){
-							++n;
-						}else{
-							n += ancestor_count(y);
-							break;
-						}
-					}
-					for(int y = x; y != std::numeric_limits<int>::max(); y = parent(y)){
-						if(ancestor_count(y) != -1){
-							assert(ancestor_count(y) == n);
-							break;
-						}else{
-							ancestor_count[y] = n;
-							--n;
-						}
-					}
-				}
-			}
+			for(int x=node_count-1; x>=0; --x)
+				ancestor_count[x] = parent(x) == -1 ? 1 : ancestor_count(parent(x)) + 1;
 
 			int max_ancestor_count = 0;
 			long long ancestor_count_sum = 0;
@@ -356,15 +541,19 @@ vector<Command>cmd = {
 				ancestor_count_sum += x;
 			}
 
-			ArrayIDFunc<int>arcs_in_search_space = out_deg;
+			// Without the arcs, huge supergraphs are examined quickly, and thus the
+			// search space sizes may exceed an int.
+			ArrayIDFunc<long long>arcs_in_search_space(node_count);
+			for(int x=0; x<node_count; ++x)
+				arcs_in_search_space[x] = out_deg(x);
 
 			for(int x=node_count-1; x>=0; --x){
-				if(parent(x) != std::numeric_limits<int>::max()){
+				if(parent(x) != -1){
 					arcs_in_search_space[x] += arcs_in_search_space(parent(x));
 				}
 			}
 
-			int max_arcs_in_search_space = 0;
+			long long max_arcs_in_search_space = 0;
 			long long arcs_in_search_space_sum = 0;
 			for(auto x:arcs_in_search_space){
 				max_to(max_arcs_in_search_space, x);
@@ -373,7 +562,7 @@ vector<Command>cmd = {
 
 			long long triangle_count = 0;
 			for(int x=0; x<node_count; ++x){
-				triangle_count += (out_deg(x)*(out_deg(x)-1))/2;
+				triangle_count += (static_cast<long long>(out_deg(x))*(out_deg(x)-1))/2;
 			}
 
 			auto w = setw(35);
@@ -399,48 +588,19 @@ vector<Command>cmd = {
 			if(node_count <= 1)
 				throw runtime_error("Graph must have at least 2 nodes");
 
-			ArrayIDFunc<int>parent(tail.image_count());
-			parent.fill(std::numeric_limits<int>::max());
-
-			compute_chordal_supergraph(
-				tail, head,
-				[&](int x, int y){
-					min_to(parent[x], y);
-				}
-			);
-
-			ArrayIDFunc<int>ancestor_count(tail.image_count());
-			ancestor_count.fill(-1);
+			auto parent = compute_symbolic_elimination(tail, head).parent;
 
-			for(int x=0; x<node_count; ++x){
-				if(ancestor_count(x) == -1){
-					int n = 0;
-					for(int y = x; y != std::numeric_limits<int>::max(); y = parent(y)){
-						if(ancestor_count(y) == -1){
-							++n;
-						}else{
-							n += ancestor_count(y);
-							break;
-						}
-					}
-					for(int y = x; y != std::numeric_limits<int>::max(); y = parent(y)){
-						if(ancestor_count(y) != -1){
-							assert(ancestor_count(y) == n);
-							break;
-						}else{
-							ancestor_count[y] = n;
-							--n;
-						}
-					}
-				}
-			}
+			// A parent has a larger ID than its children.
+			ArrayIDFunc<int>ancestor_count(node_count);
+			for(int x=node_count-1; x>=0; --x)
+				ancestor_count[x] = parent(x) == -1 ? 1 : ancestor_count(parent(x)) + 1;
 
 			int x = max_preimage_over_id_func(ancestor_count);
 
 			BitIDFunc in_tree(node_count);
 			in_tree.fill(false);
 
-			while(parent(x) != std::numeric_limits<int>::max()){
+			while(parent(x) != -1){
 				in_tree.set(x, true);
 				x = parent(x);
 			}
@@ -579,6 +739,46 @@ vector<Command>cmd = {
 					node_color[i] = new_color;
 		}
 	},
+	{
+		"load_compressed_graph", 1,
+		"Loads a graph, its weights and its coordinates from the compressed container format. The arcs are sorted by tail and head.",
+		[](vector<string>args){
+			auto graph = load_compressed_graph(args[0]);
+			tail = std::move(graph.tail);
+			head = std::move(graph.head);
+			mark_graph_changed();
+			node_weight = std::move(graph.node_weight);
+			arc_weight = std::move(graph.arc_weight);
+			node_geo_pos = load_compressed_graph_geo_pos(args[0]);
+			arc_original_position = identity_permutation(tail.preimage_count());
+
+			node_color = ArrayIDIDFunc(tail.image_count(), 1);
+			node_color.fill(0);
+			node_original_position = identity_permutation(tail.image_count());
+			arc_color = ArrayIDIDFunc(tail.preimage_count(), 1);
+			arc_color.fill(0);
+		}
+	},
+	{
+		"load_compressed_graph_arc_weight", 1,
+		"Only loads the arc weights from the compressed container format. The arcs must be sorted by tail and head.",
+		[](vector<string>args){
+			auto weight = load_compressed_graph_arc_weight(args[0]);
+			if(weight.preimage_count() != tail.preimage_count())
+				throw std::runtime_error("weight vector does not have a length equal to the number of arcs");
+			arc_weight = std::move(weight);
+		}
+	},
+	{
+		"load_compressed_graph_geo_pos", 1,
+		"Only loads the node coordinates from the compressed container format.",
+		[](vector<string>args){
+			auto geo_pos = load_compressed_graph_geo_pos(args[0]);
+			if(geo_pos.preimage_count() != tail.image_count())
+				throw std::runtime_error("coordinate vector does not have a length equal to the number of nodes");
+			node_geo_pos = std::move(geo_pos);
+		}
+	},
 	{
 		"load_binary_graph", 1,
 		"Loads a graph in the binary format.",
@@ -586,6 +786,7 @@ vector<Command>cmd = {
 			auto graph = load_binary_graph(args[0]);
 			tail = std::move(graph.tail);
 			head = std::move(graph.head);
+			mark_graph_changed();
 			node_weight = std::move(graph.node_weight);
 			arc_weight = std::move(graph.arc_weight);
 			arc_original_position = identity_permutation(tail.preimage_count());
@@ -606,6 +807,7 @@ vector<Command>cmd = {
 			auto graph = load_dimacs_graph(args[0]);
 			tail = std::move(graph.tail);
 			head = std::move(graph.head);
+			mark_graph_changed();
 			node_weight = std::move(graph.node_weight);
 			arc_weight = std::move(graph.arc_weight);
 			arc_original_position = identity_permutation(tail.preimage_count());
@@ -636,6 +838,7 @@ vector<Command>cmd = {
 
 			tail = id_id_func(new_tail.size(), tail.image_count(), [&](int x){return new_tail[x];});
 			head = id_id_func(new_head.size(), head.image_count(), [&](int x){return new_head[x];});
+			mark_graph_changed();
 
 			node_weight = id_func(tail.image_count(), [](int){return 1;});
 			arc_weight = id_func(tail.preimage_count(), [](int){return 1;});
@@ -651,6 +854,7 @@ vector<Command>cmd = {
 			auto graph = load_color_dimacs_graph(args[0]);
 			tail = std::move(graph.tail);
 			head = std::move(graph.head);
+			mark_graph_changed();
 			node_weight = std::move(graph.node_weight);
 			arc_weight = std::move(graph.arc_weight);
 			arc_original_position = identity_permutation(tail.preimage_count());
@@ -671,6 +875,7 @@ vector<Command>cmd = {
 			auto graph = load_metis_graph(args[0]);
 			tail = std::move(graph.tail);
 			head = std::move(graph.head);
+			mark_graph_changed();
 			node_weight = std::move(graph.node_weight);
 			arc_weight = std::move(graph.arc_weight);
 			arc_original_position = identity_permutation(tail.preimage_count());
@@ -684,18 +889,61 @@ vector<Command>cmd = {
 			arc_color.fill(0);
 		}
 	},
+	{
+		"generate_grid_graph", 2,
+		"Replaces the graph by a grid whose width and height are given as parameters. Neighboring nodes are 0.001 degrees apart. All weights are set to 1.",
+		[](vector<string>args){
+			replace_graph_by_generated_graph(generate_grid_graph(stoi(args[0]), stoi(args[1])));
+		}
+	},
+	{
+		"generate_perturbed_grid_graph", 4,
+		"Replaces the graph by a connected road-like graph. The nodes of a grid with the width and height given as first and second parameter are moved by up to a third of the grid spacing. A random spanning tree of the grid is kept together with every other grid edge with the probability given as third parameter. The fourth parameter is the random seed. All weights are set to 1. The graph is generated in parallel and does not depend on the thread count.",
+		[](vector<string>args){
+			replace_graph_by_generated_graph(generate_perturbed_grid_graph(stoi(args[0]), stoi(args[1]), stod(args[2]), stoull(args[3])));
+		}
+	},
+	{
+		"generate_random_geometric_graph", 3,
+		"Replaces the graph by a random geometric graph. The number of nodes given as first parameter are placed uniformly at random in a square and each is connected to its nearest neighbors. Their number is the second parameter. The third parameter is the random seed. Like a Delaunay triangulation, the graph is planar-ish, but it may be disconnected. All weights are set to 1. The graph is generated in parallel and does not depend on the thread count.",
+		[](vector<string>args){
+			replace_graph_by_generated_graph(generate_random_geometric_graph(stoi(args[0]), stoi(args[1]), stoull(args[2])));
+		}
+	},
+	{
+		"generate_highway_graph", 5,
+		"Replaces the graph by a connected graph with a highway hierarchy and long degree-two chains. The junctions form a perturbed grid with the width and height given as first and second parameter. Every road between two junctions is a chain of up to the fourth parameter many degree-two nodes. On each of the levels 1 to the third parameter minus one, every junction at a multiple of 4^level in both grid coordinates has a highway to the next such junction to its right and below. A highway is a chain of up to 4^level times the fourth parameter many degree-two nodes. The fifth parameter is the random seed. All weights are set to 1. The graph is generated in parallel and does not depend on the thread count.",
+		[](vector<string>args){
+			replace_graph_by_generated_graph(generate_highway_graph(stoi(args[0]), stoi(args[1]), stoi(args[2]), stoi(args[3]), stoull(args[4])));
+		}
+	},
 	{
 		"load_routingkit_unweighted_graph", 2,
 		"Loads a graph in the RoutingKit first_out/head format",
 		[](vector<string>args){
-			auto first_out = load_vector<unsigned>(args[0]);
+			auto first_out = map_vector<unsigned>(args[0]);
+			auto v_head = map_vector<unsigned>(args[1]);
+			if(first_out.empty() || first_out[0] != 0 || first_out.back() != v_head.size())
+				throw std::runtime_error("first_out and head do not form a graph");
 			int node_count = first_out.size()-1;
 			int arc_count = first_out.back();
-			auto v_tail = invert_inverse_vector(first_out);
-			auto v_head = load_vector<unsigned>(args[1]);
 
-			tail = id_id_func(arc_count, node_count, [&](int i)->int{return v_tail[i];});
-			head = id_id_func(arc_count, node_count, [&](int i)->int{return v_head[i];});
+			// Validate everything before the first write, such that a corrupt file
+			// neither overflows tail nor leaves a partially loaded graph behind.
+			for(int x=0; x<node_count; ++x)
+				if(first_out[x] > first_out[x+1])
+					throw std::runtime_error("first_out must be sorted");
+			for(int i=0; i<arc_count; ++i)
+				if(v_head[i] >= (unsigned)node_count)
+					throw std::runtime_error("head contains a node id that is too large");
+
+			tail = ArrayIDIDFunc(arc_count, node_count);
+			for(int x=0; x<node_count; ++x)
+				std::fill(tail.begin() + first_out[x], tail.begin() + first_out[x+1], x);
+			head = ArrayIDIDFunc(arc_count, node_count);
+			for(int i=0; i<arc_count; ++i)
+				head[i] = v_head[i];
+			mark_graph_changed();
 			node_weight = ArrayIDFunc<int>(node_count);
 			node_weight.fill(0);
 			arc_weight = ArrayIDFunc<int>(arc_count);
@@ -743,7 +991,7 @@ vector<Command>cmd = {
 		"load_routingkit_arc_weight", 1,
 		"Loads an arc weight in the RoutingKit travel_time/geo_dist format",
 		[](vector<string>args){
-			auto weight = load_vector<unsigned>(args[0]);
+			auto weight = map_vector<unsigned>(args[0]);
 			int arc_count = tail.preimage_count();
 			if(arc_count != (int)weight.size())
 				throw std::runtime_error("weight vector does not have a length equal to the number of arcs");
@@ -768,7 +1016,7 @@ vector<Command>cmd = {
 		"load_routingkit_longitude", 1,
 		"Loads the node longitudes from the RoutingKit format",
 		[](vector<string>args){
-			auto lon = load_vector<float>(args[0]);
+			auto lon = map_vector<float>(args[0]);
 			int node_count = tail.image_count();
 			if(node_count != (int)lon.size())
 				throw std::runtime_error("weight vector does not have a length equal to the number of nodes");
@@ -781,7 +1029,7 @@ vector<Command>cmd = {
 		"load_routingkit_latitude", 1,
 		"Loads the node latitudes from the RoutingKit format",
 		[](vector<string>args){
-			auto lat = load_vector<float>(args[0]);
+			auto lat = map_vector<float>(args[0]);
 			int node_count = tail.image_count();
 			if(node_count != (int)lat.size())
 				throw std::runtime_error("weight vector does not have a length equal to the number of nodes");
@@ -830,6 +1078,21 @@ vector<Command>cmd = {
 			save_vector(args[0], order);
 		}
 	},
+	{
+		"save_cch_structure", 1,
+		"Saves the upward arcs, the elimination tree, and the lower triangles of the chordal supergraph produced by contracting the nodes increasing by ID in the binary format described in cch_structure.h. The ranks are mapped to the node IDs since the last load, such that customize and query can load the file together with the saved node permutation.",
+		[](vector<string>args){
+			if(!is_symmetric(tail, head))
+				throw runtime_error("Graph must be symmetric");
+			if(node_original_position.image_count() != node_original_position.preimage_count())
+				throw runtime_error("Not possible because the node count got modified");
+
+			auto cch = compute_cch_structure(tail, head, node_original_position);
+			save_cch_structure(args[0], cch);
+			cout << "upward arc count : " << cch.arc_count() << '\n'
+				<< "triangle count : " << cch.triangle_count() << endl;
+		}
+	},
 	{
 		"load_dimacs_geo_pos", 1,
 		"Loads geo positions in the DIMACS format.",
@@ -936,6 +1199,25 @@ vector<Command>cmd = {
 			save_binary_graph(args[0], tail, head, node_weight, arc_weight);
 		}
 	},
+	{
+		"save_compressed_graph", 1,
+		"Saves the graph, its weights and its coordinates in the compressed container format.",
+		[](vector<string>args){
+			save_compressed_graph(args[0], tail, head, node_weight, arc_weight, node_geo_pos);
+		}
+	},
+	{
+		"examine_compressed_graph", 1,
+		"Lists the sections of a file in the compressed container format.",
+		[](vector<string>args){
+			long long total_byte_count = 0;
+			for(auto&s:examine_compressed_graph(args[0])){
+				cout << s.name << " : " << s.element_count << " elements in " << s.byte_count << " bytes" << endl;
+				total_byte_count += s.byte_count;
+			}
+			cout << "total : " << total_byte_count << " bytes" << endl;
+		}
+	},
 	{
 		"save_dimacs_graph", 1,
 		"Saves a weighted graph in the DIMACS format.",
@@ -1223,6 +1505,7 @@ vector<Command>cmd = {
 		"Reverses all arcs",
 		[]{
 			head.swap(tail);
+			mark_graph_changed();
 		}
 	},
 	{
@@ -1314,6 +1597,7 @@ vector<Command>cmd = {
 			ArrayIDIDFunc new_original_position = keep_if(keep_flag, new_arc_count, extended_arc_original_position);//this is weird...
 			tail = move(new_tail);
 			head = move(new_head);
+			mark_graph_changed();
 			arc_weight = move(new_arc_weight);
 			arc_color = move(new_arc_color);
 			arc_original_position = move(new_original_position);
@@ -1349,6 +1633,7 @@ vector<Command>cmd = {
 
 			tail = add_preimage_at_end(std::move(tail), neighbor_count*2);
 			head = add_preimage_at_end(std::move(head), neighbor_count*2);
+			mark_graph_changed();
 			arc_original_position = add_preimage_at_end(std::move(arc_original_position), neighbor_count*2);
 
 			int i = old_arc_count;
@@ -1379,7 +1664,7 @@ vector<Command>cmd = {
 		"list_back_arcs", 1,
 		"Lists the back arc of every arc",
 		[](vector<string>args){
-			auto back_arc = compute_back_arc_permutation(tail, head);
+			const auto&back_arc = get_back_arc();
 			save_text_file(
 				args[0],
 				[&](ostream&out){
@@ -1753,7 +2038,7 @@ vector<Command>cmd = {
 			if(s < 0 || s >= tail.image_count())
 				throw std::runtime_error("s is out of bounds");
 
-			auto out_arc = invert_id_id_func(tail);
+			const auto&out_arc = get_out_arc();
 			auto dist = compute_distances(out_arc, head, arc_weight, s);
 
 
@@ -1776,7 +2061,7 @@ vector<Command>cmd = {
 			if(s < 0 || s >= tail.image_count())
 				throw std::runtime_error("s is out of bounds");
 
-			auto out_arc = invert_id_id_func(tail);
+			const auto&out_arc = get_out_arc();
 
 
 			save_text_file(
@@ -1800,7 +2085,7 @@ vector<Command>cmd = {
 		"compute_all_pair_distance_tree", 1,
 		"Computes the shortest path trees stores them as labeled parenthesis list to file arg2. The i-th line corresponds to source node i.",
 		[](vector<string>arg){
-			auto out_arc = invert_id_id_func(tail);
+			const auto&out_arc = get_out_arc();
 			save_text_file(
 				arg[0],
 				[&](std::ostream&o){
@@ -1892,7 +2177,7 @@ vector<Command>cmd = {
             }
 
             auto out_arc = invert_sorted_id_id_func(tail);
-            auto back_arc = compute_back_arc_permutation(tail, head);
+            const auto&back_arc = get_back_arc();
 
             auto graph = flow_cutter_accelerated::make_graph(
                     make_const_ref_id_id_func(tail),
@@ -2006,7 +2291,7 @@ vector<Command>cmd = {
 
 
 			auto out_arc = invert_sorted_id_id_func(tail);
-			auto back_arc = compute_back_arc_permutation(tail, head);
+			const auto&back_arc = get_back_arc();
 
 			auto graph = flow_cutter::make_graph(
 				make_const_ref_id_id_func(tail),
@@ -2120,7 +2405,7 @@ vector<Command>cmd = {
 		}
 
 		auto out_arc = invert_sorted_id_id_func(tail);
-		auto back_arc = compute_back_arc_permutation(tail, head);
+		const auto&back_arc = get_back_arc();
 
 		auto expanded_graph = flow_cutter::expanded_graph::make_graph(
 			make_const_ref_id_id_func(tail),
@@ -2216,6 +2501,7 @@ vector<Command>cmd = {
 
 		head.swap(new_head);
 		tail.swap(new_tail);
+		mark_graph_changed();
 		arc_color.swap(new_arc_color);
 		arc_weight.swap(new_arc_weight);
 
@@ -2494,6 +2780,33 @@ vector<Command>cmd = {
 	}
 },
 
+{
+	"accelerated_flow_cutter_separator", 1,
+	"Computes a separator of the whole graph using the accelerated flow cutter and saves it as text file.",
+	[](vector<string>args){
+		if(!is_symmetric(tail, head))
+			throw runtime_error("Graph must be symmetric");
+		if(has_multi_arcs(tail, head))
+			throw runtime_error("Graph must not have multi arcs");
+		if(!is_loop_free(tail, head))
+			throw runtime_error("Graph must not have loops");
+		if(!is_connected(tail, head))
+			throw runtime_error("Graph must be connected");
+		if(!is_sorted(tail.begin(), tail.end()))
+			throw runtime_error("Arc tails must be sorted");
+
+		tbb::global_control gc(tbb::global_control::max_allowed_parallelism, flow_cutter_config.thread_count);
+		auto separator = flow_cutter::ComputeSeparator<flow_cutter_accelerated::CutterFactory, ArrayIDFunc<GeoPos>>(node_geo_pos, flow_cutter_config)(
+			tail, head, id_id_func(tail.image_count(), tail.image_count(), [](int x){return x;}), arc_weight
+		);
+		cout << "separator size : " << separator.size() << endl;
+		save_text_file(args[0], [&](std::ostream&out){
+			for(auto x:separator)
+				out << x << '\n';
+		});
+	}
+},
+
 
 
 {
@@ -2799,7 +3112,7 @@ vector<Command>cmd = {
 		if(!is_symmetric(tail, head))
 			throw runtime_error("This DFS variant only works on symmetric graphs");
 		symmetric_depth_first_search(
-			invert_id_id_func(tail),
+			get_out_arc(),
 			head,
 			[](int v){
 				cout << "First visit to root " << v << endl;
@@ -2825,7 +3138,7 @@ vector<Command>cmd = {
 	[]{
 		if(!is_symmetric(tail, head))
 			throw runtime_error("Can only color the 2-connected components of a symmetric graph");
-		arc_color = compute_biconnected_components(invert_id_id_func(tail), head, compute_back_arc_permutation(tail, head));
+		arc_color = compute_biconnected_components(get_out_arc(), head, get_back_arc());
 	}
 },
 {
@@ -2899,6 +3212,41 @@ vector<Command>cmd = {
 		permutate_nodes(order);
 	}
 },
+{
+	"reorder_nodes_in_accelerated_flow_cutter_cch_order_with_checkpoint", 1,
+	"Does the same as reorder_nodes_in_accelerated_flow_cutter_cch_order, but periodically saves the separators and orders of the finished sub-problems to the checkpoint file given as parameter. An existing file is overwritten.",
+	[](vector<string>args){
+		reorder_nodes_in_accelerated_flow_cutter_cch_order_with_checkpoint(args[0], false);
+	}
+},
+{
+	"resume_accelerated_flow_cutter_cch_order", 1,
+	"Continues an order computation of reorder_nodes_in_accelerated_flow_cutter_cch_order_with_checkpoint that was aborted, using the checkpoint file given as parameter. The graph and the flow cutter config must be the same as for the aborted run, except for the thread count. The result is the same order as without the abort. The checkpoint file is extended while the computation continues.",
+	[](vector<string>args){
+		reorder_nodes_in_accelerated_flow_cutter_cch_order_with_checkpoint(args[0], true);
+	}
+},
+{
+	"reorder_nodes_in_accelerated_flow_cutter_cch_order_and_save_separator_hierarchy", 1,
+	"Does the same as reorder_nodes_in_accelerated_flow_cutter_cch_order and saves the separators of all nested dissection levels to the file given as parameter. The node ids in the file are those of the last loaded graph.",
+	[](vector<string>args){
+		reorder_nodes_in_accelerated_flow_cutter_cch_order_with_separator_hierarchy("", args[0]);
+	}
+},
+{
+	"reorder_nodes_in_accelerated_flow_cutter_cch_order_and_save_trace", 2,
+	"Does the same as reorder_nodes_in_accelerated_flow_cutter_cch_order and saves a trace of the computation in the Chrome trace event format to the file given as first parameter. For every sub-problem, the trace records the reduction that handled it, its recursion depth, the thread and the time. For separators, it also records the augmentations, pierces, bulk piercings, distance time and flow time of every cutter, and the idle time of the threads that enumerated the cutters. Sub-problems with fewer nodes than the second parameter are left out of the file, but like all others counted in the per-depth summary that is printed.",
+	[](vector<string>args){
+		reorder_nodes_in_accelerated_flow_cutter_cch_order_with_trace(args[0], stoi(args[1]));
+	}
+},
+{
+	"reorder_nodes_in_accelerated_flow_cutter_cch_order_incrementally", 2,
+	"Reorders all nodes like reorder_nodes_in_accelerated_flow_cutter_cch_order, but reuses the separators of the hierarchy in the file given as first parameter wherever they are still valid. The hierarchy must have been saved for a graph with the same node ids, for example, before arcs were added or removed. Only the sub-problems whose separators became invalid are dissected anew. The resulting hierarchy is saved to the file given as second parameter.",
+	[](vector<string>args){
+		reorder_nodes_in_accelerated_flow_cutter_cch_order_with_separator_hierarchy(args[0], args[1]);
+	}
+},
 
 {
 	"reorder_nodes_at_random",
@@ -3052,6 +3400,50 @@ vector<Command>cmd = {
 
 };
 
+// Processes one line of the interactive mode or of a client of the serve command.
+// Returns false if the line was exit.
+bool execute_command_line(const string&line){
+	try{
+		istringstream line_in(line);
+		string command;
+		if(!(line_in >> command))
+			return true;
+
+		if(command == "exit")
+			return false;
+
+		int c = -1;
+		for(int i=0; i<(int)cmd.size(); ++i)
+			if(cmd[i].name == command){
+				c = i;
+				break;
+			}
+		if(c == -1)
+			throw runtime_error("Unknown command "+command);
+
+		vector<string>args;
+		string x;
+		while(line_in >> x)
+			args.push_back(x);
+		if((int)args.size() != cmd[c].parameter_count)
+			throw runtime_error("Wrong number of parameters to command "+cmd[c].name+". expected:"+to_string(cmd[c].parameter_count)+", got:"+to_string(args.size()));
+
+		auto prev_time_commands = time_commands;
+		long long time = -get_micro_time();
+		cmd[c].func(move(args));
+		time += get_micro_time();
+
+		if(time_commands && prev_time_commands){
+			cout << "running time : "<<time << "musec" << endl;
+		}
+
+		check_graph_consitency();
+	}catch(std::exception&err){
+		cout << "Exception : " << err.what() << endl;
+	}
+	return true;
+}
+
 int main(int argc, char*argv[]){
 	try{
 		if(argc == 1){
@@ -5,16 +5,19 @@
 #include "flow_cutter.h"
 #include "flow_cutter_config.h"
 
-#include <tbb/spin_mutex.h>
+#include "concurrent_best_cut.h"
 
 #include <deque>
+#include <memory>
+#include <tuple>
+#include <type_traits>
 
 namespace flow_cutter{
 
 	template <typename CutterFactory, class GetGeoPos>
 	class ComputeCut{
 	public:
-		explicit ComputeCut(const GetGeoPos& geo_pos, Config config, bool reorder_arcs = true):geo_pos(geo_pos), config(config), reorder_arcs(reorder_arcs){}
+		explicit ComputeCut(const GetGeoPos& geo_pos, Config config, bool reorder_arcs = true):geo_pos(geo_pos), config(config), reorder_arcs(reorder_arcs), projection_orders(make_projection_orders(geo_pos, config)){}
 
 		template<class Tail, class Head, class InputNodeID, class ArcWeight>
 		std::deque<int> operator()(const Tail&tail, const Head&head, const InputNodeID& input_node_id, const ArcWeight&arc_weight)const{
@@ -41,14 +44,13 @@ namespace flow_cutter{
 						make_const_ref_id_func(out_arc)
 					);
 					auto cutter = factory(graph);
-					auto pairs = factory.select_source_target_pairs(node_count, adapted_geo_pos, config.cutter_count, config.random_seed);
+					auto pairs = select_source_target_pairs(factory, node_count, adapted_geo_pos, input_node_id);
 
-					std::atomic<double> best_score(std::numeric_limits<double>::max());
-					int best_flow_intensity = std::numeric_limits<int>::max();
-					int best_cutter_id = std::numeric_limits<int>::max();
+					// Ordered by score, then flow intensity, then cutter id. If reorder_arcs is set,
+					// then the cut arcs are stored such that their heads are on the smaller side.
+					ConcurrentBestCut<std::tuple<double, int, int>, std::vector<int>> snapshot_best_cut(std::make_tuple(std::numeric_limits<double>::max(), std::numeric_limits<int>::max(), std::numeric_limits<int>::max()));
 					
 					cutter.init(pairs, config.random_seed, adapted_geo_pos);
-					tbb::spin_mutex current_cut_mutex;
 
 					cutter.enum_cuts(
 						/* shall_continue */
@@ -59,7 +61,7 @@ namespace flow_cutter{
 								cut_size += 1;
 							}
 							double potential_best_next_score = cut_size/(double)(node_count/2);
-							return potential_best_next_score < best_score.load(std::memory_order_acquire);
+							return potential_best_next_score < std::get<0>(snapshot_best_cut.get_best_key());
 						},
 						/* report_cut */
 						[&](const auto& cutter, int cutter_id) {
@@ -72,41 +74,32 @@ namespace flow_cutter{
 							if(cutter.get_current_smaller_cut_side_size() < config.max_imbalance * node_count)
 								score += 1000000;
 
-							if(score <= best_score.load(std::memory_order_acquire)) {
-								tbb::spin_mutex::scoped_lock cut_lock(current_cut_mutex);
-
-								double tmp_best_score = best_score.load(std::memory_order_acquire);
-								if (std::tie(score, cut_size, cutter_id) < std::tie(tmp_best_score, best_flow_intensity, best_cutter_id)) {
-									best_score.store(score, std::memory_order_release);
-									best_flow_intensity = cut_size;
-									best_cutter_id = cutter_id;
-									/* order edges by direction */
-
-									//TODO are those x real edges? are those all edges?
-									std::deque<int> cur_cut;
-									auto cut = cutter.get_current_cut();
-									if (reorder_arcs) {
-										for (auto x : cut) {
-											if (cutter.is_on_smaller_side(head(x))) {
-												cur_cut.push_back(x);
-												cur_cut.push_front(back_arc(x));
-											} else {
-												cur_cut.push_front(x);
-												cur_cut.push_back(back_arc(x));
-											}
-										}
-									} else {
-										for (auto x : cut) {
-											cur_cut.push_back(x);
-											cur_cut.push_back(back_arc(x));
-										}
-									}
-									best_cut = cur_cut;
-								}
-							}
+							snapshot_best_cut.try_publish(std::make_tuple(score, cutter.get_current_flow_intensity(), cutter_id), [&]{
+								std::vector<int> cut = cutter.get_current_cut();
+								if (reorder_arcs)
+									for (auto& x : cut)
+										if (!cutter.is_on_smaller_side(head(x)))
+											x = back_arc(x);
+								return cut;
+							});
 						},
 						/* report_cuts_in_order */
 						false);
+
+					/* order edges by direction */
+
+					//TODO are those x real edges? are those all edges?
+					if (reorder_arcs) {
+						for (auto x : snapshot_best_cut.get_best_cut()) {
+							best_cut.push_back(x);
+							best_cut.push_front(back_arc(x));
+						}
+					} else {
+						for (auto x : snapshot_best_cut.get_best_cut()) {
+							best_cut.push_back(x);
+							best_cut.push_back(back_arc(x));
+						}
+					}
 				}
 				break;
 				default:
@@ -116,9 +109,27 @@ namespace flow_cutter{
 		}
 
 	private:
+		template<class Factory, class AdaptedGeoPos, class InputNodeID>
+		auto select_source_target_pairs(Factory& factory, int node_count, AdaptedGeoPos& adapted_geo_pos, const InputNodeID& input_node_id)const{
+			if(projection_orders)
+				return factory.select_source_target_pairs(node_count, *projection_orders, input_node_id, config.cutter_count, config.random_seed);
+			else
+				return factory.select_source_target_pairs(node_count, adapted_geo_pos, config.cutter_count, config.random_seed);
+		}
+
+
+		//! Only the accelerated cutters start from the projection orders, the others ignore them.
+		static std::shared_ptr<const flow_cutter_accelerated::InertialProjectionOrders> make_projection_orders(const GetGeoPos& geo_pos, const Config& config){
+			if(std::is_same<CutterFactory, flow_cutter_accelerated::CutterFactory>::value && config.reuse_geo_orders == Config::ReuseGeoOrders::yes)
+				return std::make_shared<const flow_cutter_accelerated::InertialProjectionOrders>(geo_pos, config.geo_pos_ordering_cutter_count);
+			else
+				return nullptr;
+		}
+
 		const GetGeoPos& geo_pos;
 		Config config;
 		const bool reorder_arcs;
+		std::shared_ptr<const flow_cutter_accelerated::InertialProjectionOrders> projection_orders;
 	};
 }
 
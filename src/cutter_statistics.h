@@ -0,0 +1,29 @@
+#ifndef CUTTER_STATISTICS_H
+#define CUTTER_STATISTICS_H
+
+namespace flow_cutter_accelerated{
+
+	//! The work of a cutter since it was initialized. Times are in microseconds and
+	//! are only measured if timing was enabled for the cutter.
+	struct CutterStatistics{
+		long long augmentation_count = 0;
+		long long pierce_count = 0;
+		long long bulk_pierce_count = 0;
+		long long distance_time = 0;
+		long long flow_time = 0;
+	};
+
+	//! How busy the threads were while the cutters of a separator computation were
+	//! enumerated in parallel. A thread idles while it neither advances a cutter nor
+	//! helps with the parallel search of another cutter. Times are in microseconds.
+	//! thread_count is 0 if the cutters were not run in parallel or if timing was not
+	//! enabled.
+	struct CutterSchedulerStatistics{
+		int thread_count = 0;
+		long long running_time = 0;
+		long long total_idle_time = 0;
+		long long max_idle_time = 0;
+	};
+}
+
+#endif
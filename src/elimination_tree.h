@@ -0,0 +1,172 @@
+#ifndef ELIMINATION_TREE_H
+#define ELIMINATION_TREE_H
+
+#include "array_id_func.h"
+#include "id_multi_func.h"
+#include <cassert>
+
+// The functions in this file describe the chordal supergraph that
+// compute_chordal_supergraph produces by contracting the nodes increasing by ID,
+// without computing its arcs. They follow the symbolic phase of sparse Cholesky
+// factorization. The running times are nearly linear in the size of the input
+// graph instead of the size of the supergraph.
+
+//! Computes the elimination tree of the chordal supergraph with Liu's algorithm.
+//! The parent of x is its lowest upward neighbor in the supergraph, or -1 if x has
+//! no upward neighbor. The ancestor array is compressed along the way.
+template<class OutArc, class Head>
+ArrayIDFunc<int> compute_elimination_tree(const OutArc&out_arc, const Head&head){
+	const int node_count = out_arc.preimage_count();
+
+	ArrayIDFunc<int>parent(node_count), ancestor(node_count);
+	for(int x=0; x<node_count; ++x){
+		parent[x] = -1;
+		ancestor[x] = -1;
+		for(auto xy:out_arc(x)){
+			int y = head(xy);
+			if(y >= x)
+				continue;
+			while(ancestor[y] != -1 && ancestor[y] != x){
+				int z = ancestor[y];
+				ancestor[y] = x;
+				y = z;
+			}
+			if(ancestor[y] == -1){
+				ancestor[y] = x;
+				parent[y] = x;
+			}
+		}
+	}
+	return parent; // NVRO
+}
+
+//! Returns the nodes of the forest in a postorder. The children of a node appear
+//! increasing by ID.
+inline ArrayIDFunc<int> compute_elimination_tree_postorder(const ArrayIDFunc<int>&parent){
+	const int node_count = parent.preimage_count();
+
+	ArrayIDFunc<int>first_child(node_count), next_sibling(node_count);
+	first_child.fill(-1);
+	for(int x=node_count-1; x>=0; --x){
+		if(parent(x) != -1){
+			next_sibling[x] = first_child[parent(x)];
+			first_child[parent(x)] = x;
+		}
+	}
+
+	ArrayIDFunc<int>postorder(node_count), stack(node_count);
+	int postorder_end = 0;
+	for(int r=0; r<node_count; ++r){
+		if(parent(r) != -1)
+			continue;
+		int stack_end = 0;
+		stack[stack_end++] = r;
+		while(stack_end != 0){
+			int x = stack[stack_end-1];
+			int c = first_child(x);
+			if(c == -1){
+				--stack_end;
+				postorder[postorder_end++] = x;
+			}else{
+				first_child[x] = next_sibling(c);
+				stack[stack_end++] = c;
+			}
+		}
+	}
+	assert(postorder_end == node_count);
+	return postorder; // NVRO
+}
+
+//! Computes the number of upward neighbors of every node in the chordal supergraph
+//! with the row and column counting algorithm of Gilbert, Ng, and Peyton. It
+//! determines for every node the leaves of its row subtrees and uses least common
+//! ancestors, found with a path compressed union find, to avoid counting a node
+//! twice.
+template<class OutArc, class Head>
+ArrayIDFunc<int> compute_upward_degree_in_chordal_supergraph(
+	const OutArc&out_arc, const Head&head,
+	const ArrayIDFunc<int>&parent, const ArrayIDFunc<int>&postorder
+){
+	const int node_count = out_arc.preimage_count();
+
+	// first_descendant[x] is the smallest postorder position in the subtree of x.
+	// delta starts as 1 for leaves and 0 for all other nodes.
+	ArrayIDFunc<int>first_descendant(node_count), delta(node_count);
+	first_descendant.fill(-1);
+	for(int k=0; k<node_count; ++k){
+		int x = postorder(k);
+		delta[x] = first_descendant(x) == -1 ? 1 : 0;
+		for(; x != -1 && first_descendant(x) == -1; x = parent(x))
+			first_descendant[x] = k;
+	}
+
+	ArrayIDFunc<int>max_first_descendant(node_count), previous_leaf(node_count), ancestor(node_count);
+	max_first_descendant.fill(-1);
+	previous_leaf.fill(-1);
+	for(int x=0; x<node_count; ++x)
+		ancestor[x] = x;
+
+	for(int k=0; k<node_count; ++k){
+		int x = postorder(k);
+		if(parent(x) != -1)
+			--delta[parent(x)];
+		for(auto xy:out_arc(x)){
+			int y = head(xy);
+
+			// Is x a leaf of the row subtree of y?
+			if(y <= x || first_descendant(x) <= max_first_descendant(y))
+				continue;
+			max_first_descendant[y] = first_descendant(x);
+			int previous = previous_leaf(y);
+			previous_leaf[y] = x;
+			++delta[x];
+			if(previous == -1)
+				continue;
+
+			// It is not the first leaf. Find the least common ancestor of the previous
+			// leaf and x and compress the path to it.
+			int lca = previous;
+			while(lca != ancestor(lca))
+				lca = ancestor(lca);
+			for(int z = previous; z != lca;){
+				int next = ancestor(z);
+				ancestor[z] = lca;
+				z = next;
+			}
+			--delta[lca];
+		}
+		if(parent(x) != -1)
+			ancestor[x] = parent(x);
+	}
+
+	// The column counts follow by summing delta over the subtrees. They include the
+	// node itself.
+	for(int x=0; x<node_count; ++x)
+		if(parent(x) != -1)
+			delta[parent(x)] += delta(x);
+	for(int x=0; x<node_count; ++x)
+		--delta[x];
+
+	return delta; // NVRO
+}
+
+struct SymbolicElimination{
+	ArrayIDFunc<int>parent;
+	ArrayIDFunc<int>upward_degree;
+};
+
+//! Computes the elimination tree and the upward degrees of the chordal supergraph
+//! that compute_chordal_supergraph produces. The graph must be symmetric.
+template<class Tail, class Head>
+SymbolicElimination compute_symbolic_elimination(const Tail&tail, const Head&head){
+	auto out_arc = invert_id_id_func(tail);
+	SymbolicElimination result;
+	result.parent = compute_elimination_tree(out_arc, head);
+	result.upward_degree = compute_upward_degree_in_chordal_supergraph(
+		out_arc, head,
+		result.parent, compute_elimination_tree_postorder(result.parent)
+	);
+	return result; // NVRO
+}
+
+#endif
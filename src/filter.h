@@ -48,6 +48,39 @@ typename std::enable_if<
 	return result; // NRVO
 }
 
+// If the array is passed as rvalue, then the kept ids are moved to the front of its
+// memory instead of allocating a new array.
+template<class Pred, class T>
+ArrayIDFunc<T> keep_if(const Pred&p, int new_preimage_count, ArrayIDFunc<T>&&f){
+	assert(p.preimage_count() == f.preimage_count());
+	assert(new_preimage_count == count_true(p));
+
+	int out = 0;
+	for(int in=0; in<f.preimage_count(); ++in)
+		if(p(in)){
+			if(in != out)
+				f[out] = f.move(in);
+			++out;
+		}
+	assert(out == new_preimage_count);
+	f.shrink_preimage_count(new_preimage_count);
+	return std::move(f);
+}
+
+template<class Pred>
+ArrayIDIDFunc keep_if(const Pred&p, int new_preimage_count, ArrayIDIDFunc&&f){
+	assert(p.preimage_count() == f.preimage_count());
+	assert(new_preimage_count == count_true(p));
+
+	int out = 0;
+	for(int in=0; in<f.preimage_count(); ++in)
+		if(p(in))
+			f[out++] = f[in];
+	assert(out == new_preimage_count);
+	f.shrink_preimage_count(new_preimage_count);
+	return std::move(f);
+}
+
 template<class Pred>
 ArrayIDIDFunc compute_keep_function(const Pred&pred, int new_image_count){
 	ArrayIDIDFunc f(pred.preimage_count(), new_image_count);
@@ -1256,6 +1256,11 @@ namespace flow_cutter{
 			return select_source_target_pairs(node_count, cutter_count, seed);
 		}
 
+		template<class ProjectionOrders, class InputNodeID>
+		std::vector<SourceTargetPair>select_source_target_pairs(int node_count, const ProjectionOrders&, const InputNodeID&, int cutter_count, int seed){
+			return select_source_target_pairs(node_count, cutter_count, seed);
+		}
+
 		std::vector<SourceTargetPair>select_source_target_pairs(int node_count, int cutter_count, int seed){
 			std::vector<SourceTargetPair>p(cutter_count);
 			std::mt19937 rng(seed);
@@ -4,11 +4,14 @@
 
 #include "tiny_id_func.h"
 #include "array_id_func.h"
+#include "timestamp_id_func.h"
+#include "atomic_bit_id_func.h"
 #include "id_string.h"
 #include "id_func.h"
 #include "dijkstra.h"
 #include "min_max.h"
 #include "flow_cutter_dinic.h"
+#include "cutter_statistics.h"
 #include <vector>
 #include <algorithm>
 #include <sstream>
@@ -16,18 +19,26 @@
 #include <memory>
 #include <atomic>
 #include <array>
+#include <functional>
+#include <utility>
 
 #include "flow_cutter_config.h"
 #include "permutation.h"
 #include "timer.h"
 #include "geo_pos.h"
+#include "id_sort.h"
 #include <iostream>
+#include <numeric>
+#include <tuple>
 
 #include <iterator>
 
 #include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#include <tbb/concurrent_priority_queue.h>
 
 namespace flow_cutter_accelerated{
 
@@ -186,6 +197,96 @@ namespace flow_cutter_accelerated{
 		}
 	};
 
+	//! Sums up per thread the time spent on the cutters of a parallel enumeration.
+	//! A thread works either on an enumeration task or helps with a nested parallel
+	//! search of another task. Nested work that a thread does while it runs a task
+	//! is part of the task time and is not counted twice.
+	class ThreadBusyTime{
+	public:
+		template<class F>
+		void run_task(const F&f){
+			auto&s = state.local();
+			s.is_in_task = true;
+			long long begin_time = get_micro_time();
+			f();
+			s.busy_time += get_micro_time() - begin_time;
+			s.is_in_task = false;
+		}
+
+		template<class F>
+		void run_nested_work(const F&f){
+			auto&s = state.local();
+			if(s.is_in_task){
+				f();
+			}else{
+				long long begin_time = get_micro_time();
+				f();
+				s.busy_time += get_micro_time() - begin_time;
+			}
+		}
+
+		//! Calls on_thread(busy_time) for every thread that did some work.
+		template<class OnThread>
+		void forall_threads(const OnThread&on_thread)const{
+			for(const auto&s : state)
+				on_thread(s.busy_time);
+		}
+
+	private:
+		struct State{
+			bool is_in_task = false;
+			long long busy_time = 0;
+		};
+		tbb::enumerable_thread_specific<State>state;
+	};
+
+	//! Marks that reachable sets that are grown completely should be grown with a level
+	//! synchronous parallel breadth first search. All other searches use
+	//! SequentialSearchAlgorithm.
+	template<class SequentialSearchAlgorithm>
+	class LevelSynchronousParallelSearch : public SequentialSearchAlgorithm{
+	public:
+		explicit LevelSynchronousParallelSearch(const SequentialSearchAlgorithm&search_algo):
+			SequentialSearchAlgorithm(search_algo){}
+
+		//! Runs a part of a parallel level scan. Its time is recorded if a busy time is set.
+		template<class F>
+		void run_nested_work(const F&f)const{
+			if(busy_time == nullptr)
+				f();
+			else
+				busy_time->run_nested_work(f);
+		}
+
+		ThreadBusyTime*busy_time = nullptr;
+	};
+
+	//! Returns a copy of search_algo whose nested parallel searches record their time in busy_time.
+	template<class SearchAlgorithm>
+	SearchAlgorithm record_nested_busy_time(const SearchAlgorithm&search_algo, ThreadBusyTime*){
+		return search_algo;
+	}
+
+	template<class SequentialSearchAlgorithm>
+	LevelSynchronousParallelSearch<SequentialSearchAlgorithm>record_nested_busy_time(const LevelSynchronousParallelSearch<SequentialSearchAlgorithm>&search_algo, ThreadBusyTime*busy_time){
+		auto s = search_algo;
+		s.busy_time = busy_time;
+		return s;
+	}
+
+	//! Strips LevelSynchronousParallelSearch. Searches that stop at the first target
+	//! should use this, as a breadth first search explores everything closer to the
+	//! target, whereas a pseudo depth first search often finds a path much faster.
+	template<class SearchAlgorithm>
+	const SearchAlgorithm&get_sequential_search(const SearchAlgorithm&search_algo){
+		return search_algo;
+	}
+
+	template<class SequentialSearchAlgorithm>
+	const SequentialSearchAlgorithm&get_sequential_search(const LevelSynchronousParallelSearch<SequentialSearchAlgorithm>&search_algo){
+		return search_algo;
+	}
+
 	struct UnitFlow{
 		UnitFlow(){}
 		explicit UnitFlow(int preimage_count):flow(preimage_count){}
@@ -229,10 +330,12 @@ namespace flow_cutter_accelerated{
 		TinyIntIDFunc<2>flow;
 	};
 
-	class BasicNodeSet{
+	template<class InsideFlag>
+	class GenericBasicNodeSet{
+		template<class> friend class GenericBasicNodeSet;
 	public:
 		template<class Graph>
-		explicit BasicNodeSet(const Graph&graph):
+		explicit GenericBasicNodeSet(const Graph&graph):
 			last_grow_index(0),
 			node_count_inside_(0),
 			inside_flag(graph.node_count()),
@@ -305,9 +408,19 @@ namespace flow_cutter_accelerated{
 			extra_nodes.push_back(x);
 		}
 
-		void copy_nodes_without_extra_nodes(const BasicNodeSet& other) {
+		//! Makes this set contain exactly the nodes of other. Requires a TimestampOverlayIDFunc
+		//! as inside flag. The nodes are not copied and thus other must not shrink afterwards.
+		template<class OtherInsideFlag>
+		void reset_nodes_without_extra_nodes(const GenericBasicNodeSet<OtherInsideFlag>& other) {
 			node_count_inside_ = other.node_count_inside_;
-			inside_flag = other.inside_flag;
+			inside_flag.reset_base(other.inside_flag);
+		}
+
+		template<class OtherInsideFlag>
+		void reset_nodes(const GenericBasicNodeSet<OtherInsideFlag>& other) {
+			reset_nodes_without_extra_nodes(other);
+			last_grow_index = other.last_grow_index;
+			extra_nodes = other.extra_nodes;
 		}
 
 		const std::vector<int>& get_extra_nodes() const {
@@ -333,10 +446,12 @@ namespace flow_cutter_accelerated{
 	private:
 		int last_grow_index;
 		int node_count_inside_;
-		BitIDFunc inside_flag;
+		InsideFlag inside_flag;
 		std::vector<int> extra_nodes;
 	};
 
+	using BasicNodeSet = GenericBasicNodeSet<BitIDFunc>;
+
 	class ReachableNodeSet;
 
 	class AssimilatedNodeSet{
@@ -434,11 +549,15 @@ namespace flow_cutter_accelerated{
 		explicit ReachableNodeSet(const Graph&graph):
 			node_set(graph), predecessor(graph.node_count()){}
 
+		//! Afterwards, the set contains exactly the assimilated nodes. Only the nodes reached
+		//! since the last reset are stored explicitly. Hence, the running time is
+		//! independent of the graph size. As the assimilated set only grows until the
+		//! next clear, it is referenced instead of copied.
 		void reset(const AssimilatedNodeSet&other, bool keep_extra){
 			if (keep_extra) {
-				node_set.copy_nodes_without_extra_nodes(other.node_set);
+				node_set.reset_nodes_without_extra_nodes(other.node_set);
 			} else {
-				node_set = other.node_set;
+				node_set.reset_nodes(other.node_set);
 			}
 		}
 
@@ -485,6 +604,83 @@ namespace flow_cutter_accelerated{
 			node_set.grow(graph, tmp, search_algo, on_new_node, my_should_follow_arc, on_new_arc);
 		}
 
+		//! Grows the set with a breadth first search from all extra nodes at once. The
+		//! arcs leaving a level are scanned in parallel, should_follow_arc and on_new_arc
+		//! must therefore be thread-safe. on_new_node is called sequentially after each
+		//! level. The reached nodes are the same as with the sequential search, but if
+		//! the search is stopped, then the path to the last node can differ.
+		template<class Graph, class SequentialSearchAlgorithm, class OnNewNode, class ShouldFollowArc, class OnNewArc>
+		void grow(
+			const Graph&graph,
+			TemporaryData&tmp,
+			const LevelSynchronousParallelSearch<SequentialSearchAlgorithm>&search_algo,
+			const OnNewNode&on_new_node,
+			const ShouldFollowArc&should_follow_arc,
+			const OnNewArc&on_new_arc
+		){
+			assert(can_grow());
+
+			if(was_claimed.preimage_count() == 0)
+				was_claimed = AtomicBitIDFunc(max_node_count_inside());
+
+			auto&queue = tmp.node_space;
+			int source_count = 0;
+			for(int x : node_set.get_extra_nodes())
+				queue[source_count++] = x;
+
+			int level_begin = 0, level_end = source_count;
+			std::atomic<int> queue_end(source_count);
+
+			auto scan_level_part = [&](int part_begin, int part_end){
+				std::vector<int>next_level_part;
+				for(int i=part_begin; i<part_end; ++i){
+					for(auto xy : graph.out_arc(queue[i])){
+						on_new_arc(xy);
+						int y = graph.head(xy);
+						if(!node_set.is_inside(y) && !was_claimed(y) && should_follow_arc(xy) && was_claimed.try_set(y)){
+							predecessor[y] = xy;
+							next_level_part.push_back(y);
+						}
+					}
+				}
+				int pos = queue_end.fetch_add(next_level_part.size(), std::memory_order_relaxed);
+				assert(pos + (int)next_level_part.size() <= queue.preimage_count());
+				std::copy(next_level_part.begin(), next_level_part.end(), &queue[pos]);
+			};
+
+			bool was_stopped = false;
+			while(level_begin != level_end && !was_stopped){
+				if(level_end - level_begin < MinParallelLevelSize){
+					scan_level_part(level_begin, level_end);
+				}else{
+					// The queue belongs to the thread local TemporaryData of this thread. The
+					// isolation prevents this thread from picking up another cutter while it waits.
+					tbb::this_task_arena::isolate([&]{
+						tbb::parallel_for(
+							tbb::blocked_range<int>(level_begin, level_end, MinParallelLevelSize/4),
+							[&](const tbb::blocked_range<int>&r){
+								search_algo.run_nested_work([&]{ scan_level_part(r.begin(), r.end()); });
+							}
+						);
+					});
+				}
+
+				level_begin = level_end;
+				level_end = queue_end.load(std::memory_order_relaxed);
+
+				for(int i=level_begin; i<level_end; ++i){
+					node_set.add_node(graph, queue[i]);
+					if(!on_new_node(queue[i])){
+						was_stopped = true;
+						break;
+					}
+				}
+			}
+
+			for(int i=source_count; i<queue_end.load(std::memory_order_relaxed); ++i)
+				was_claimed.reset(queue[i]);
+		}
+
 		bool is_inside(int x) const {
 			return node_set.is_inside(x);
 		}
@@ -507,8 +703,11 @@ namespace flow_cutter_accelerated{
 		}
 
 	private:
-		BasicNodeSet node_set;
+		static constexpr int MinParallelLevelSize = 1024;
+
+		GenericBasicNodeSet<TimestampOverlayIDFunc<BitIDFunc>> node_set;
 		ArrayIDFunc<int>predecessor;
+		AtomicBitIDFunc was_claimed; // only allocated by the parallel search
 	};
 
 	struct SourceTargetPair{
@@ -553,6 +752,7 @@ namespace flow_cutter_accelerated{
 			has_cut = false;
 			initial_flow = true;
 			side = 0;
+			statistics = CutterStatistics();
 
 			perform_bulk_piercing = st.source == -1 && st.target == -1 && !node_order.empty();
 			if (perform_bulk_piercing) {
@@ -561,6 +761,8 @@ namespace flow_cutter_accelerated{
 					assimilated[source_side].add_extra_node(graph, node_order.front());
 					reachable[source_side].add_node(graph, node_order.front());
 					reachable[source_side].add_extra_node(graph, node_order.front());
+				} else {
+					++statistics.bulk_pierce_count;
 				}
 
 				if (!bulk_piercing(graph, target_side, config.initial_assimilated_fraction, true)) {
@@ -568,6 +770,8 @@ namespace flow_cutter_accelerated{
 					assimilated[target_side].add_extra_node(graph, node_order.back());
 					reachable[target_side].add_node(graph, node_order.back());
 					reachable[target_side].add_extra_node(graph, node_order.back());
+				} else {
+					++statistics.bulk_pierce_count;
 				}
 			}
 			else {
@@ -628,6 +832,21 @@ namespace flow_cutter_accelerated{
 		//! anything.
 		template<class Graph, class SearchAlgorithm, class ScorePierceNode>
 		bool advance(const Graph&graph, TemporaryData&tmp, const SearchAlgorithm&search_algo, const ScorePierceNode&score_pierce_node){
+			if(!is_timed)
+				return advance_untimed(graph, tmp, search_algo, score_pierce_node);
+			statistics.flow_time -= get_micro_time();
+			bool found_cut = advance_untimed(graph, tmp, search_algo, score_pierce_node);
+			statistics.flow_time += get_micro_time();
+			return found_cut;
+		}
+
+		bool is_not_finished()const{
+			return can_advance;
+		}
+
+	private:
+		template<class Graph, class SearchAlgorithm, class ScorePierceNode>
+		bool advance_untimed(const Graph&graph, TemporaryData&tmp, const SearchAlgorithm&search_algo, const ScorePierceNode&score_pierce_node){
 			assert(can_advance);
 			bool has_pierced = false;
 
@@ -649,13 +868,17 @@ namespace flow_cutter_accelerated{
 						can_advance = false;
 						return false;
 					}
+					++statistics.pierce_count;
 
 					assert(!assimilated[1-side].is_inside(pierce_node));
 
-					assimilated[side].add_node(graph, pierce_node);
-					assimilated[side].add_extra_node(graph, pierce_node);
+					// The reachable set references the assimilated set. Hence, it must be extended first.
 					reachable[side].add_node(graph, pierce_node);
 					reachable[side].add_extra_node(graph, pierce_node);
+					assimilated[side].add_node(graph, pierce_node);
+					assimilated[side].add_extra_node(graph, pierce_node);
+				} else {
+					++statistics.bulk_pierce_count;
 				}
 
 				has_cut = false;
@@ -672,9 +895,7 @@ namespace flow_cutter_accelerated{
 			return true;
 		}
 
-		bool is_not_finished()const{
-			return can_advance;
-		}
+	public:
 
 		template<class Graph, class ScorePierceNode>
 		bool does_next_advance_increase_flow(const Graph &graph, const ScorePierceNode &score_pierce_node){
@@ -736,6 +957,16 @@ namespace flow_cutter_accelerated{
 			return initial_flow;
 		}
 
+		//! The flow time is only measured if timing is enabled, as reading the clock on
+		//! every advance costs time that only a trace needs. The counts are always kept.
+		void set_timed(bool timed){
+			is_timed = timed;
+		}
+
+		const CutterStatistics&get_statistics()const{
+			return statistics;
+		}
+
 	private:
 
 		bool perform_bulk_piercing = true;
@@ -818,8 +1049,8 @@ namespace flow_cutter_accelerated{
 			while ((int)newly_assimilated.size() < nodes_to_assimilate) {
 				int node = get_next_node_from_order(side);
 				if (node == -1) break;
-				assimilated[side].add_node(graph, node);
 				reachable[side].add_node(graph, node);
+				assimilated[side].add_node(graph, node);
 				newly_assimilated.push_back(node);
 			}
 			for (int node : newly_assimilated) {
@@ -847,8 +1078,8 @@ namespace flow_cutter_accelerated{
 				auto try_assimilate_node = [&](int node) {
 					if (!assimilated[source_side].is_inside(node) && !assimilated[target_side].is_inside(node)) {
 						newly_assimilated.push_back(node);
-						assimilated[side].add_node(graph, node);
 						reachable[side].add_node(graph, node);
+						assimilated[side].add_node(graph, node);
 					}
 				};
 				nodes_to_assimilate = std::min(nodes_to_assimilate, remaining_bulk_nodes(side));
@@ -973,7 +1204,7 @@ namespace flow_cutter_accelerated{
 				};
 				auto should_follow_arc = [&](int xy) { return !is_forward_saturated(xy); };
 				auto on_new_arc = [](int) {};
-				reachable[my_source_side].grow(graph, tmp, search_algo, on_new_node, should_follow_arc, on_new_arc);
+				reachable[my_source_side].grow(graph, tmp, get_sequential_search(search_algo), on_new_node, should_follow_arc, on_new_arc);
 
 				if (target_hit != -1) {
 					check_flow_conservation(graph);
@@ -981,6 +1212,7 @@ namespace flow_cutter_accelerated{
 					check_flow_conservation(graph);
 					reachable[my_source_side].reset(assimilated[my_source_side], true);
 					++flow_intensity;
+					++statistics.augmentation_count;
 
 					was_flow_augmented = true;
 					check_flow_conservation(graph);
@@ -1120,10 +1352,11 @@ namespace flow_cutter_accelerated{
 		std::array<int, 2> order_pointer;
 		const flow_cutter::Config& config;
 		std::mt19937 rng;
+		CutterStatistics statistics;
+		bool is_timed = false;
 	};
 
 
-
 	enum class DistanceType{
 		no_distance,
 		hop_distance,
@@ -1221,6 +1454,8 @@ namespace flow_cutter_accelerated{
 
 			int terminal_set_size = std::max(static_cast<int>(node_order.size() * bulk_distance_factor), 1);
 
+			if (is_timed)
+				distance_time = -get_micro_time();
 			switch(dist_type){
 			case DistanceType::hop_distance:
 				compute_hop_distance_from(graph, tmp, source, node_dist[source_side]);
@@ -1276,6 +1511,8 @@ namespace flow_cutter_accelerated{
 #endif
 				}
 			}
+			if (is_timed)
+				distance_time += get_micro_time();
 			cutter.init(graph, tmp, search_algo, std::move(node_order), random_seed, ti.st);
 		}
 
@@ -1346,10 +1583,49 @@ namespace flow_cutter_accelerated{
 			return node_dist[0].preimage_count();
 		}
 
+		//! Must be called before init to also measure the distance computation.
+		void set_timed(bool timed){
+			is_timed = timed;
+			cutter.set_timed(timed);
+		}
+
+		CutterStatistics get_statistics()const{
+			CutterStatistics s = cutter.get_statistics();
+			s.distance_time = distance_time;
+			return s;
+		}
+
 	private:
 		BasicCutter cutter;
 		ArrayIDFunc<int>node_dist[2];
 		const flow_cutter::Config& config;
+		long long distance_time = 0;
+		bool is_timed = false;
+	};
+
+	//! Hands out the cutters that no thread works on, the one with the lowest flow
+	//! intensity first. The flow intensity of a waiting cutter does not change.
+	class CutterScheduler{
+	public:
+		void release(int cutter_id, int flow_intensity){
+			waiting_cutters.push(std::make_pair(flow_intensity, cutter_id));
+		}
+
+		//! Returns -1 if no cutter is waiting.
+		int try_acquire(){
+			std::pair<int, int> p;
+			if(waiting_cutters.try_pop(p))
+				return p.second;
+			else
+				return -1;
+		}
+
+		bool has_waiting_cutter()const{
+			return !waiting_cutters.empty();
+		}
+
+	private:
+		tbb::concurrent_priority_queue<std::pair<int, int>, std::greater<std::pair<int, int>>> waiting_cutters;
 	};
 
 	class MultiCutter{
@@ -1374,6 +1650,8 @@ namespace flow_cutter_accelerated{
 				cutter_list.pop_back(); // can not use resize because that requires default constructor...
 			while(cutter_list.size() < terminal_info.size())
 				cutter_list.emplace_back(graph, config);
+			for (auto& c : cutter_list)
+				c.set_timed(is_timed);
 
 			if (graph.node_count() > ParallelismCutoff)
 				tbb::parallel_for(size_t(0), cutter_list.size(), [&](size_t i) { cutter_list[i].init(graph, tmp.local(), search_algo, dist_type, std::move(terminal_info[i]), bulk_distance_factor, random_seed+1+i, geo_pos); } );
@@ -1389,62 +1667,16 @@ namespace flow_cutter_accelerated{
 
 		template<class Graph, class SearchAlgorithm, class ScorePierceNode, class ShallContinue, class ReportCut>
 		bool parallel_enum_cuts(const Graph&graph, const SearchAlgorithm&search_algo, const ScorePierceNode&score_pierce_node, const ShallContinue &shall_continue, const ReportCut &report_cut) {
-			// Work around atomic_flag not being copyable
-			std::vector<std::atomic_flag> cutter_running(cutter_list.size());
-			for (auto &r : cutter_running) {
-				r.clear();
-			}
-
-			// Work around std::atomic not being copyable
-			std::vector<std::atomic<bool>> cutter_active(cutter_list.size());
-			for (auto &a : cutter_active) {
-				a = true;
-			}
-
-
-			tbb::enumerable_thread_specific<std::vector<std::pair<int, int>>> tmp_cutter_flow;
-
-			std::atomic<int> acquired_cutters(0);
-
-
-			auto get_cutter_to_work_on = [&]() -> int {
-				auto &my_cutter_flow = tmp_cutter_flow.local();
-				my_cutter_flow.clear();
-				my_cutter_flow.reserve(cutter_list.size());
-
-				for (int i = 0; i < static_cast<int>(cutter_list.size()); ++i) {
-					if (cutter_active[i].load(std::memory_order_consume)) {
-					    my_cutter_flow.emplace_back(i, cutter_list[i].get_current_flow_intensity());
-					}
-				}
-
-				std::sort(my_cutter_flow.begin(), my_cutter_flow.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
-
-				for (auto & cutter_flow : my_cutter_flow) {
-					int cutter_id = cutter_flow.first;
-					if (!cutter_running[cutter_id].test_and_set(std::memory_order_acquire)) {
-						acquired_cutters++;
-						return cutter_id;
-					}
-				}
-
-				return -1;
-			};
-
-
-
+			CutterScheduler scheduler;
+			for (int i = 0; i < static_cast<int>(cutter_list.size()); ++i)
+				scheduler.release(i, cutter_list[i].get_current_flow_intensity());
 
-			tbb::parallel_for(static_cast<size_t>(0), cutter_list.size(), [&](const size_t task_id) {
-				int cutter_id = task_id;
-				std::vector<int> task_local_flow_augs(cutter_list.size(), 0);
-				std::vector<int> task_local_cuts(cutter_list.size(), 0);
+			ThreadBusyTime busy_time;
+			auto my_search_algo = record_nested_busy_time(search_algo, is_timed ? &busy_time : nullptr);
+			long long begin_time = is_timed ? get_micro_time() : 0;
 
-				if (cutter_running[cutter_id].test_and_set(std::memory_order_acquire)) {
-					cutter_id = get_cutter_to_work_on();
-				}
-				else {
-					acquired_cutters++;
-				}
+			auto run_task = [&]() {
+				int cutter_id = scheduler.try_acquire();
 
 				while (cutter_id != -1) {
 					auto& c = cutter_list[cutter_id];
@@ -1455,45 +1687,81 @@ namespace flow_cutter_accelerated{
 												    source_dist, target_dist, cutter_id);
 					};
 
-					//reassess memory fence and assess overhead for distributing cutters.
-					if (cutter_active[cutter_id].load(std::memory_order_consume)) {
-						std::atomic_thread_fence(std::memory_order_consume);
-
-						if (c.is_not_finished() && shall_continue(c)) {
-
-
-							task_local_flow_augs[cutter_id]++;
-							if (!c.advance(graph, tmp.local(), search_algo, my_score_pierce_node)) {
-								cutter_active[cutter_id].store(false, std::memory_order_release);
-							}
-							else if (c.cut_available()) {
-								task_local_flow_augs[cutter_id]--;
-								task_local_cuts[cutter_id]++;
-								while (!c.does_next_advance_increase_flow(graph, my_score_pierce_node)) {
-									c.advance(graph, tmp.local(), search_algo, my_score_pierce_node);
-								}
-
-								report_cut(c, cutter_id);
-							}
-						}
-						else {
-							cutter_active[cutter_id].store(false, std::memory_order_release);
+					bool is_cutter_active = c.is_not_finished() && shall_continue(c);
+					if (is_cutter_active) {
+						if (!c.advance(graph, tmp.local(), my_search_algo, my_score_pierce_node)) {
+							is_cutter_active = false;
 						}
+						else if (c.cut_available()) {
+							while (!c.does_next_advance_increase_flow(graph, my_score_pierce_node)) {
+								c.advance(graph, tmp.local(), my_search_algo, my_score_pierce_node);
+							}
 
-						std::atomic_thread_fence(std::memory_order_release);
+							report_cut(c, cutter_id);
+						}
 					}
 
-					if (acquired_cutters != (int)cutter_list.size() || !cutter_active[cutter_id]) {
-						cutter_running[cutter_id].clear(std::memory_order_release);
-						acquired_cutters--;
-						cutter_id = get_cutter_to_work_on();
+					// Finished cutters are dropped. If other cutters wait, then the cutter with
+					// the lowest flow intensity is continued, which might be the current one.
+					if (!is_cutter_active) {
+						cutter_id = scheduler.try_acquire();
+					} else if (scheduler.has_waiting_cutter()) {
+						scheduler.release(cutter_id, c.get_current_flow_intensity());
+						cutter_id = scheduler.try_acquire();
 					}
 				}
+			};
+
+			tbb::parallel_for(static_cast<size_t>(0), cutter_list.size(), [&](const size_t) {
+				if (is_timed)
+					busy_time.run_task(run_task);
+				else
+					run_task();
+			});
+
+			scheduler_statistics = CutterSchedulerStatistics();
+			if (!is_timed)
+				return false;
+
+			long long end_time = get_micro_time();
+			scheduler_statistics.thread_count = tbb::this_task_arena::max_concurrency();
+			scheduler_statistics.running_time = end_time - begin_time;
+			int participating_thread_count = 0;
+			busy_time.forall_threads([&](long long thread_busy_time) {
+				++participating_thread_count;
+				long long idle_time = scheduler_statistics.running_time - thread_busy_time;
+				if (idle_time < 0)
+					idle_time = 0;
+				scheduler_statistics.total_idle_time += idle_time;
+				max_to(scheduler_statistics.max_idle_time, idle_time);
 			});
+			if (participating_thread_count < scheduler_statistics.thread_count) {
+				scheduler_statistics.total_idle_time += (scheduler_statistics.thread_count - participating_thread_count) * scheduler_statistics.running_time;
+				scheduler_statistics.max_idle_time = scheduler_statistics.running_time;
+			}
 
 			return false;
 		}
 
+		//! Enables the time measurements of the cutters and of the scheduler. They are
+		//! off by default, such that only a traced computation pays for them. Must be
+		//! called before init.
+		void set_timed(bool timed){
+			is_timed = timed;
+		}
+
+		//! Statistics of the last parallel enumeration. Times are in microseconds.
+		const CutterSchedulerStatistics& get_scheduler_statistics() const {
+			return scheduler_statistics;
+		}
+
+		std::vector<CutterStatistics> get_cutter_statistics() const {
+			std::vector<CutterStatistics> s;
+			for (const auto& c : cutter_list)
+				s.push_back(c.get_statistics());
+			return s;
+		}
+
 		/**
 		 * Enumerate all cuts
 		 * @param graph The graph to use.
@@ -1501,10 +1769,22 @@ namespace flow_cutter_accelerated{
 		 * @param score_pierce_node The pierce node scoring
 		 * @param shall_continue Callback that gets the current flow value of a cutter and returns a boolean if the cutter shall continue
 		 * @param report_cut Callback that receives the cut.
+		 *
+		 * If there are more threads than cutters, then the remaining threads are used
+		 * within the cutters to grow the reachable sets in parallel.
 		 */
 		template<class Graph, class SearchAlgorithm, class ScorePierceNode, class ShallContinue, class ReportCut>
 		void enum_cuts(const Graph&graph, const SearchAlgorithm&search_algo, const ScorePierceNode&score_pierce_node, const ShallContinue &shall_continue, const ReportCut &report_cut, const bool report_cuts_in_order) {
+			if (graph.node_count() > ParallelismCutoff && (int)cutter_list.size() < config.thread_count)
+				enum_cuts_with_search(graph, LevelSynchronousParallelSearch<SearchAlgorithm>(search_algo), score_pierce_node, shall_continue, report_cut, report_cuts_in_order);
+			else
+				enum_cuts_with_search(graph, search_algo, score_pierce_node, shall_continue, report_cut, report_cuts_in_order);
+		}
 
+		static constexpr int ParallelismCutoff = 5000;
+	private:
+		template<class Graph, class SearchAlgorithm, class ScorePierceNode, class ShallContinue, class ReportCut>
+		void enum_cuts_with_search(const Graph&graph, const SearchAlgorithm&search_algo, const ScorePierceNode&score_pierce_node, const ShallContinue &shall_continue, const ReportCut &report_cut, const bool report_cuts_in_order) {
 
 			if (!report_cuts_in_order && graph.node_count() > ParallelismCutoff && config.thread_count > 1) {
 				parallel_enum_cuts(graph, search_algo, score_pierce_node, shall_continue, report_cut);
@@ -1615,11 +1895,11 @@ namespace flow_cutter_accelerated{
 			}
 		}
 
-		static constexpr int ParallelismCutoff = 5000;
-	private:
 		std::vector<DistanceAwareCutter>cutter_list;
 		tbb::enumerable_thread_specific<TemporaryData> tmp;
 		const flow_cutter::Config& config;
+		CutterSchedulerStatistics scheduler_statistics;
+		bool is_timed = false;
 	};
 
 	struct PierceNodeScore{
@@ -1800,12 +2080,100 @@ namespace flow_cutter_accelerated{
 		CutterStateDump dump_state()const{
 			return cutter.dump_state();
 		}
+
+		void set_timed(bool timed){
+			cutter.set_timed(timed);
+		}
+
+		const CutterSchedulerStatistics& get_scheduler_statistics() const {
+			return cutter.get_scheduler_statistics();
+		}
+
+		std::vector<CutterStatistics> get_cutter_statistics() const {
+			return cutter.get_cutter_statistics();
+		}
 	private:
 		const Graph&graph;
 		MultiCutter cutter;
 		const flow_cutter::Config& config;
 	};
 
+	//! The inertial projection orders of all nodes of the top-level graph. Every direction
+	//! is sorted only once. A subgraph obtains its orders by restricting the global ranks
+	//! to its nodes, which are identified through the input_node_id function of the
+	//! nested dissection recursion.
+	class InertialProjectionOrders{
+	public:
+		template<class GetGeoPos>
+		InertialProjectionOrders(const GetGeoPos& geo_pos, int direction_count):
+			rank(direction_count){
+			if (direction_count < 4) throw std::runtime_error("At least four inertial flow orders are required.");
+			const int node_count = geo_pos.preimage_count();
+			digit_base = 1;
+			while(static_cast<long long>(digit_base)*digit_base < node_count)
+				++digit_base;
+
+			auto build_rank = [&](int i){
+				const GeoPos multiplier = projection_direction(i, direction_count);
+				ArrayIDFunc<double>projection(node_count);
+				for(int x=0; x<node_count; ++x)
+					projection[x] = geo_pos(x).lat * multiplier.lat + geo_pos(x).lon * multiplier.lon;
+				std::vector<int>order(node_count);
+				std::iota(order.begin(), order.end(), 0);
+				std::sort(order.begin(), order.end(), [&](int l, int r){
+					return std::tie(projection(l), l) < std::tie(projection(r), r);
+				});
+				rank[i] = ArrayIDFunc<int>(node_count);
+				for(int p=0; p<node_count; ++p)
+					rank[i][order[p]] = p;
+			};
+
+			if(node_count > MultiCutter::ParallelismCutoff/2)
+				tbb::parallel_for(0, direction_count, build_rank);
+			else
+				for(int i=0; i<direction_count; ++i){ build_rank(i); }
+		}
+
+		static GeoPos projection_direction(int i, int direction_count){
+			const double pi  = 3.141592653589793238463;
+			const double phi = i * pi / direction_count;
+			return { std::cos(phi), std::sin(phi) };
+		}
+
+		int direction_count()const{
+			return rank.size();
+		}
+
+		//! Returns the local nodes 0..input_node_id.preimage_count()-1 sorted by their position
+		//! in the global projection order of the given direction. Since ranks are distinct
+		//! integers below the global node count, two stable counting sort passes by digits
+		//! of base ~sqrt(global node count) suffice, i.e., the running time is linear in the
+		//! subgraph size plus the digit base.
+		template<class InputNodeID>
+		std::vector<int> restrict_order(int direction, const InputNodeID& input_node_id)const{
+			const auto& r = rank[direction];
+			const int node_count = input_node_id.preimage_count();
+
+			std::vector<int>order(node_count);
+			std::iota(order.begin(), order.end(), 0);
+
+			if(node_count <= digit_base){
+				std::sort(order.begin(), order.end(), [&](int l, int r_){
+					return r(input_node_id(l)) < r(input_node_id(r_));
+				});
+			}else{
+				std::vector<int>tmp(node_count);
+				stable_sort_copy_by_id(order.begin(), order.end(), tmp.begin(), digit_base, [&](int x){ return r(input_node_id(x)) % digit_base; });
+				stable_sort_copy_by_id(tmp.begin(), tmp.end(), order.begin(), digit_base, [&](int x){ return r(input_node_id(x)) / digit_base; });
+			}
+			return order;
+		}
+
+	private:
+		std::vector<ArrayIDFunc<int>>rank;
+		int digit_base;
+	};
+
 	class CutterFactory {
 	public:
 		explicit CutterFactory(const flow_cutter::Config& config) : config(config) { }
@@ -1833,6 +2201,28 @@ namespace flow_cutter_accelerated{
 			return res;
 		}
 
+		//! Same as above, but the inertial flow orders are restricted from the precomputed
+		//! orders of the top-level graph instead of being sorted anew.
+		template<class InputNodeID>
+		MultiCutter::TerminalInformation select_source_target_pairs(int node_count, const InertialProjectionOrders& projection_orders, const InputNodeID& input_node_id, int /*cutter_count*/, int seed) {
+			MultiCutter::TerminalInformation res;
+			for (int i = 0; i < projection_orders.direction_count(); ++i)
+				res.push_back({ std::vector<int>(0), false, SourceTargetPair{-1, -1}, i });
+			auto restrict_one_order = [&](int i) {
+				res[i].node_order = projection_orders.restrict_order(i, input_node_id);
+			};
+			if (node_count > MultiCutter::ParallelismCutoff/2)
+				tbb::parallel_for(0, projection_orders.direction_count(), restrict_one_order);
+			else
+				for (int i = 0; i < projection_orders.direction_count(); i++) { restrict_one_order(i); }
+
+			auto st = select_random_source_target_pairs(node_count, config.distance_ordering_cutter_count, seed);
+			for (int i = 0; i < config.distance_ordering_cutter_count; ++i) {
+				res.push_back({ std::vector<int>(0), true, st[i], projection_orders.direction_count() + i });
+			}
+			return res;
+		}
+
 		template<class CompGeoPos>
 		std::vector<int> build_geo_order(int node_count, const CompGeoPos &comp_geo_pos) {
 			std::vector<int> node_order(node_count);
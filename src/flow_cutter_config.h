@@ -47,6 +47,12 @@ namespace flow_cutter{
 		};
 		AvoidAugmentingPath avoid_augmenting_path;
 
+		enum class ExpandedGraphLayout{
+			on_the_fly,
+			materialized
+		};
+		ExpandedGraphLayout expanded_graph_layout;
+
 		enum class SkipNonMaximumSides{
 			skip,
 			no_skip
@@ -66,6 +72,12 @@ namespace flow_cutter{
 		};
 		DumpState dump_state;
 
+		enum class ReuseGeoOrders{
+			no,
+			yes
+		};
+		ReuseGeoOrders reuse_geo_orders;
+
 		enum class ReportCuts{
 			yes,
 			no
@@ -110,9 +122,11 @@ namespace flow_cutter{
 			bulk_distance(BulkDistance::no),
 			separator_selection(SeparatorSelection::node_min_expansion),
 			avoid_augmenting_path(AvoidAugmentingPath::avoid_and_pick_best),
+			expanded_graph_layout(ExpandedGraphLayout::on_the_fly),
 			skip_non_maximum_sides(SkipNonMaximumSides::skip),
 			graph_search_algorithm(GraphSearchAlgorithm::pseudo_depth_first_search),
 			dump_state(DumpState::no),
+			reuse_geo_orders(ReuseGeoOrders::no),
 			report_cuts(ReportCuts::yes),
 			pierce_rating(PierceRating::max_target_minus_source_hop_dist){}
 
@@ -144,6 +158,12 @@ namespace flow_cutter{
 				else if(val == "avoid_and_pick_random" || val_id == static_cast<int>(AvoidAugmentingPath::avoid_and_pick_random)) 
 					avoid_augmenting_path = AvoidAugmentingPath::avoid_and_pick_random;
 				else throw std::runtime_error("Unknown config value "+val+" for variable AvoidAugmentingPath; valid are avoid_and_pick_best, do_not_avoid, avoid_and_pick_oldest, avoid_and_pick_random");
+			}else if(var == "ExpandedGraphLayout" || var == "expanded_graph_layout"){
+				if(val == "on_the_fly" || val_id == static_cast<int>(ExpandedGraphLayout::on_the_fly)) 
+					expanded_graph_layout = ExpandedGraphLayout::on_the_fly;
+				else if(val == "materialized" || val_id == static_cast<int>(ExpandedGraphLayout::materialized)) 
+					expanded_graph_layout = ExpandedGraphLayout::materialized;
+				else throw std::runtime_error("Unknown config value "+val+" for variable ExpandedGraphLayout; valid are on_the_fly, materialized");
 			}else if(var == "SkipNonMaximumSides" || var == "skip_non_maximum_sides"){
 				if(val == "skip" || val_id == static_cast<int>(SkipNonMaximumSides::skip)) 
 					skip_non_maximum_sides = SkipNonMaximumSides::skip;
@@ -164,6 +184,12 @@ namespace flow_cutter{
 				else if(val == "yes" || val_id == static_cast<int>(DumpState::yes)) 
 					dump_state = DumpState::yes;
 				else throw std::runtime_error("Unknown config value "+val+" for variable DumpState; valid are no, yes");
+			}else if(var == "ReuseGeoOrders" || var == "reuse_geo_orders"){
+				if(val == "no" || val_id == static_cast<int>(ReuseGeoOrders::no)) 
+					reuse_geo_orders = ReuseGeoOrders::no;
+				else if(val == "yes" || val_id == static_cast<int>(ReuseGeoOrders::yes)) 
+					reuse_geo_orders = ReuseGeoOrders::yes;
+				else throw std::runtime_error("Unknown config value "+val+" for variable ReuseGeoOrders; valid are no, yes");
 			}else if(var == "ReportCuts" || var == "report_cuts"){
 				if(val == "yes" || val_id == static_cast<int>(ReportCuts::yes)) 
 					report_cuts = ReportCuts::yes;
@@ -277,7 +303,7 @@ namespace flow_cutter{
 				if(!(x>=0))
 					throw std::runtime_error("Value for \"distance_ordering_cutter_count\" must fullfill \"x>=0\"");
 				distance_ordering_cutter_count = x; 
-			}else throw std::runtime_error("Unknown config variable "+var+"; valid are BulkDistance, SeparatorSelection, AvoidAugmentingPath, SkipNonMaximumSides, GraphSearchAlgorithm, DumpState, ReportCuts, PierceRating, cutter_count, random_seed, source, target, thread_count, max_cut_size, max_imbalance, branch_factor, chunk_size, bulk_distance_factor, bulk_assimilation_threshold, bulk_assimilation_order_threshold, initial_assimilated_fraction, bulk_step_fraction, geo_pos_ordering_cutter_count, distance_ordering_cutter_count");
+			}else throw std::runtime_error("Unknown config variable "+var+"; valid are BulkDistance, SeparatorSelection, AvoidAugmentingPath, ExpandedGraphLayout, SkipNonMaximumSides, GraphSearchAlgorithm, DumpState, ReuseGeoOrders, ReportCuts, PierceRating, cutter_count, random_seed, source, target, thread_count, max_cut_size, max_imbalance, branch_factor, chunk_size, bulk_distance_factor, bulk_assimilation_threshold, bulk_assimilation_order_threshold, initial_assimilated_fraction, bulk_step_fraction, geo_pos_ordering_cutter_count, distance_ordering_cutter_count");
 		}
 		std::string get(const std::string&var)const{
 			if(var == "BulkDistance" || var == "bulk_distance"){
@@ -296,6 +322,10 @@ namespace flow_cutter{
 				else if(avoid_augmenting_path == AvoidAugmentingPath::avoid_and_pick_oldest) return "avoid_and_pick_oldest";
 				else if(avoid_augmenting_path == AvoidAugmentingPath::avoid_and_pick_random) return "avoid_and_pick_random";
 				else {assert(false); return "";}
+			}else if(var == "ExpandedGraphLayout" || var == "expanded_graph_layout"){
+				if(expanded_graph_layout == ExpandedGraphLayout::on_the_fly) return "on_the_fly";
+				else if(expanded_graph_layout == ExpandedGraphLayout::materialized) return "materialized";
+				else {assert(false); return "";}
 			}else if(var == "SkipNonMaximumSides" || var == "skip_non_maximum_sides"){
 				if(skip_non_maximum_sides == SkipNonMaximumSides::skip) return "skip";
 				else if(skip_non_maximum_sides == SkipNonMaximumSides::no_skip) return "no_skip";
@@ -309,6 +339,10 @@ namespace flow_cutter{
 				if(dump_state == DumpState::no) return "no";
 				else if(dump_state == DumpState::yes) return "yes";
 				else {assert(false); return "";}
+			}else if(var == "ReuseGeoOrders" || var == "reuse_geo_orders"){
+				if(reuse_geo_orders == ReuseGeoOrders::no) return "no";
+				else if(reuse_geo_orders == ReuseGeoOrders::yes) return "yes";
+				else {assert(false); return "";}
 			}else if(var == "ReportCuts" || var == "report_cuts"){
 				if(report_cuts == ReportCuts::yes) return "yes";
 				else if(report_cuts == ReportCuts::no) return "no";
@@ -361,7 +395,7 @@ namespace flow_cutter{
 				return std::to_string(geo_pos_ordering_cutter_count);
 			}else if(var == "distance_ordering_cutter_count"){
 				return std::to_string(distance_ordering_cutter_count);
-			}else throw std::runtime_error("Unknown config variable "+var+"; valid are BulkDistance,SeparatorSelection,AvoidAugmentingPath,SkipNonMaximumSides,GraphSearchAlgorithm,DumpState,ReportCuts,PierceRating, cutter_count, random_seed, source, target, thread_count, max_cut_size, max_imbalance, branch_factor, chunk_size, bulk_distance_factor, bulk_assimilation_threshold, bulk_assimilation_order_threshold, initial_assimilated_fraction, bulk_step_fraction, geo_pos_ordering_cutter_count, distance_ordering_cutter_count");
+			}else throw std::runtime_error("Unknown config variable "+var+"; valid are BulkDistance,SeparatorSelection,AvoidAugmentingPath,ExpandedGraphLayout,SkipNonMaximumSides,GraphSearchAlgorithm,DumpState,ReuseGeoOrders,ReportCuts,PierceRating, cutter_count, random_seed, source, target, thread_count, max_cut_size, max_imbalance, branch_factor, chunk_size, bulk_distance_factor, bulk_assimilation_threshold, bulk_assimilation_order_threshold, initial_assimilated_fraction, bulk_step_fraction, geo_pos_ordering_cutter_count, distance_ordering_cutter_count");
 		}
 		std::string get_config()const{
 			std::ostringstream out;
@@ -369,9 +403,11 @@ namespace flow_cutter{
 				<< std::setw(30) << "BulkDistance" << " : " << get("BulkDistance") << '\n'
 				<< std::setw(30) << "SeparatorSelection" << " : " << get("SeparatorSelection") << '\n'
 				<< std::setw(30) << "AvoidAugmentingPath" << " : " << get("AvoidAugmentingPath") << '\n'
+				<< std::setw(30) << "ExpandedGraphLayout" << " : " << get("ExpandedGraphLayout") << '\n'
 				<< std::setw(30) << "SkipNonMaximumSides" << " : " << get("SkipNonMaximumSides") << '\n'
 				<< std::setw(30) << "GraphSearchAlgorithm" << " : " << get("GraphSearchAlgorithm") << '\n'
 				<< std::setw(30) << "DumpState" << " : " << get("DumpState") << '\n'
+				<< std::setw(30) << "ReuseGeoOrders" << " : " << get("ReuseGeoOrders") << '\n'
 				<< std::setw(30) << "ReportCuts" << " : " << get("ReportCuts") << '\n'
 				<< std::setw(30) << "PierceRating" << " : " << get("PierceRating") << '\n'
 				<< std::setw(30) << "cutter_count" << " : " << get("cutter_count") << '\n'
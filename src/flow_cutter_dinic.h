@@ -3,6 +3,7 @@
 
 #include "tiny_id_func.h"
 #include "array_id_func.h"
+#include "timestamp_id_func.h"
 
 namespace flow_cutter_accelerated{
 
@@ -188,10 +189,11 @@ namespace flow_cutter_accelerated{
 		int node_count, arc_count;
 
 		int flow_intensity;
-		BitIDFunc is_blocked;
+		// Both are reset in every phase. The timestamps make this independent of the graph size.
+		TimestampIDFunc is_blocked;
 
 		ArrayIDFunc<int> queue;
-		BitIDFunc is_on_same_level_or_lower;
+		TimestampIDFunc is_on_same_level_or_lower;
 
 		ArrayIDFunc<int>current_path_node;
 		ArrayIDFunc<int>current_path_arc;
@@ -0,0 +1,461 @@
+#ifndef GRAPH_GENERATOR_H
+#define GRAPH_GENERATOR_H
+
+#include "array_id_func.h"
+#include "geo_pos.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <cmath>
+#include <cstdint>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+//! The generators build synthetic graphs with coordinates in parallel. Every
+//! random decision is drawn from a counter based generator, i.e., it only depends
+//! on the seed and on the node or edge that it is made for. The generated graphs
+//! therefore do not depend on the number of threads.
+//!
+//! A generated graph is symmetric, has neither loops nor multi-arcs, and its arcs
+//! are sorted first by tail and second by head. Neighboring grid nodes are 0.001
+//! degrees apart.
+
+struct GeneratedGraph{
+	int node_count()const{ return tail.image_count(); }
+	int arc_count()const{ return tail.preimage_count(); }
+
+	ArrayIDIDFunc tail, head;
+	ArrayIDFunc<GeoPos>geo_pos;
+};
+
+//! The i-th number of a stream is a splitmix64 hash of the stream seed and i.
+class GeneratorRandomStream{
+public:
+	GeneratorRandomStream(std::uint64_t seed, std::uint64_t stream):
+		seed(mix(mix(seed) ^ stream)){}
+
+	std::uint64_t bits(std::uint64_t i)const{
+		return mix(seed + i);
+	}
+
+	//! Uniform in [0, 1).
+	double real(std::uint64_t i)const{
+		return (bits(i) >> 11) * (1.0/9007199254740992.0);
+	}
+
+	//! Uniform in [min, max].
+	int integer(std::uint64_t i, int min, int max)const{
+		return min + static_cast<int>(bits(i) % static_cast<std::uint64_t>(max - min + 1));
+	}
+
+private:
+	static std::uint64_t mix(std::uint64_t z){
+		z += 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	std::uint64_t seed;
+};
+
+namespace graph_generator_detail{
+	const int block_size = 1 << 12;
+
+	inline int get_block_count(int item_count){
+		return (item_count + block_size - 1) / block_size;
+	}
+
+	struct CountingEmitter{
+		int add_node(GeoPos){
+			return node_count++;
+		}
+
+		void add_edge(int, int){
+			++edge_count;
+		}
+
+		int node_count = 0;
+		long long edge_count = 0;
+	};
+
+	struct WritingEmitter{
+		int add_node(GeoPos p){
+			geo_pos[next_node - first_node] = p;
+			return next_node++;
+		}
+
+		void add_edge(int x, int y){
+			*next_edge++ = {x, y};
+		}
+
+		GeoPos*geo_pos;
+		int first_node, next_node;
+		std::pair<int, int>*next_edge;
+	};
+
+	template<class Emitter>
+	void add_chain(Emitter&emit, int x, GeoPos x_pos, int y, GeoPos y_pos, int chain_node_count){
+		int prev = x;
+		for(int i=1; i<=chain_node_count; ++i){
+			double t = static_cast<double>(i)/(chain_node_count+1);
+			int mid = emit.add_node({x_pos.lat + t*(y_pos.lat - x_pos.lat), x_pos.lon + t*(y_pos.lon - x_pos.lon)});
+			emit.add_edge(prev, mid);
+			prev = mid;
+		}
+		emit.add_edge(prev, y);
+	}
+
+	inline void check_grid_size(int width, int height){
+		if(width <= 0 || height <= 0)
+			throw std::runtime_error("The grid must have a positive width and height");
+		if(static_cast<long long>(width)*height > std::numeric_limits<int>::max()/4)
+			throw std::runtime_error("The grid is too large");
+	}
+
+	//! The nodes of the perturbed grid are moved by up to a third of the grid
+	//! spacing. Every node except the first picks its left or upper neighbor as
+	//! parent, which yields a random spanning tree. The edges to the parents and
+	//! every other edge with probability extra_edge_probability are kept.
+	struct PerturbedGrid{
+		PerturbedGrid(int width, double extra_edge_probability, std::uint64_t seed):
+			width(width), extra_edge_probability(extra_edge_probability),
+			jitter(seed, 0), parent(seed, 1), keep(seed, 2){}
+
+		GeoPos geo_pos(int x)const{
+			return {
+				0.001*(x / width + (jitter.real(2*x) - 0.5)*2/3),
+				0.001*(x % width + (jitter.real(2*x+1) - 0.5)*2/3)
+			};
+		}
+
+		bool is_parent_left(int x)const{
+			if(x < width)
+				return true;
+			if(x % width == 0)
+				return false;
+			return parent.bits(x) & 1;
+		}
+
+		bool has_left_edge(int x)const{
+			return x % width != 0 && (is_parent_left(x) || keep.real(2*x) < extra_edge_probability);
+		}
+
+		bool has_up_edge(int x)const{
+			return x >= width && (!is_parent_left(x) || keep.real(2*x+1) < extra_edge_probability);
+		}
+
+		int width;
+		double extra_edge_probability;
+		GeneratorRandomStream jitter, parent, keep;
+	};
+}
+
+//! Builds the symmetric graph from a list of undirected edges in parallel. Every
+//! edge must appear only once and must not be a loop.
+inline
+GeneratedGraph build_generated_graph(const std::vector<std::pair<int, int>>&edge, ArrayIDFunc<GeoPos>geo_pos){
+	const int node_count = geo_pos.preimage_count();
+	if(edge.size() > static_cast<std::size_t>(std::numeric_limits<int>::max()/2))
+		throw std::runtime_error("Too many edges");
+	const int edge_count = edge.size();
+	const int arc_count = 2*edge_count;
+
+	std::unique_ptr<std::atomic<int>[]>next_arc(new std::atomic<int>[node_count]);
+	tbb::parallel_for(0, node_count, [&](int x){ next_arc[x].store(0, std::memory_order_relaxed); });
+	tbb::parallel_for(0, edge_count, [&](int i){
+		next_arc[edge[i].first].fetch_add(1, std::memory_order_relaxed);
+		next_arc[edge[i].second].fetch_add(1, std::memory_order_relaxed);
+	});
+
+	// Exclusive prefix sum over the degrees, computed in blocks.
+	const int block_count = graph_generator_detail::get_block_count(node_count);
+	std::vector<int>block_begin(block_count+1, 0);
+	tbb::parallel_for(0, block_count, [&](int b){
+		int sum = 0;
+		for(int x=b*graph_generator_detail::block_size; x<std::min(node_count, (b+1)*graph_generator_detail::block_size); ++x)
+			sum += next_arc[x].load(std::memory_order_relaxed);
+		block_begin[b+1] = sum;
+	});
+	for(int b=0; b<block_count; ++b)
+		block_begin[b+1] += block_begin[b];
+	ArrayIDFunc<int>first_out(node_count+1);
+	first_out[node_count] = arc_count;
+	tbb::parallel_for(0, block_count, [&](int b){
+		int sum = block_begin[b];
+		for(int x=b*graph_generator_detail::block_size; x<std::min(node_count, (b+1)*graph_generator_detail::block_size); ++x){
+			first_out[x] = sum;
+			sum += next_arc[x].load(std::memory_order_relaxed);
+			next_arc[x].store(first_out[x], std::memory_order_relaxed);
+		}
+	});
+
+	GeneratedGraph g;
+	g.tail = ArrayIDIDFunc(arc_count, node_count);
+	g.head = ArrayIDIDFunc(arc_count, node_count);
+	tbb::parallel_for(0, edge_count, [&](int i){
+		int x = edge[i].first, y = edge[i].second;
+		g.head[next_arc[x].fetch_add(1, std::memory_order_relaxed)] = y;
+		g.head[next_arc[y].fetch_add(1, std::memory_order_relaxed)] = x;
+	});
+	tbb::parallel_for(0, node_count, [&](int x){
+		std::fill(g.tail.begin() + first_out(x), g.tail.begin() + first_out(x+1), x);
+		std::sort(g.head.begin() + first_out(x), g.head.begin() + first_out(x+1));
+	});
+	g.geo_pos = std::move(geo_pos);
+	return g; // NVRO
+}
+
+//! Calls generate(i, emit) in parallel for every i in [0, item_count) to build
+//! a graph. The first first_node_count nodes exist from the beginning and node x
+//! is at get_first_node_geo_pos(x). emit.add_node(p) adds a further node at p and
+//! returns its ID, and emit.add_edge(x, y) adds an edge. generate is called twice
+//! for every item and must emit the same nodes and edges both times.
+template<class GetFirstNodeGeoPos, class Generate>
+GeneratedGraph generate_graph_in_parallel(int first_node_count, const GetFirstNodeGeoPos&get_first_node_geo_pos, int item_count, const Generate&generate){
+	using namespace graph_generator_detail;
+
+	const int block_count = get_block_count(item_count);
+	std::vector<long long>block_node_begin(block_count+1, 0), block_edge_begin(block_count+1, 0);
+	tbb::parallel_for(0, block_count, [&](int b){
+		CountingEmitter emit;
+		for(int i=b*block_size; i<std::min(item_count, (b+1)*block_size); ++i)
+			generate(i, emit);
+		block_node_begin[b+1] = emit.node_count;
+		block_edge_begin[b+1] = emit.edge_count;
+	});
+	block_node_begin[0] = first_node_count;
+	for(int b=0; b<block_count; ++b){
+		block_node_begin[b+1] += block_node_begin[b];
+		block_edge_begin[b+1] += block_edge_begin[b];
+	}
+	if(block_node_begin[block_count] > std::numeric_limits<int>::max())
+		throw std::runtime_error("Too many nodes");
+	if(block_edge_begin[block_count] > std::numeric_limits<int>::max()/2)
+		throw std::runtime_error("Too many edges");
+
+	const int node_count = block_node_begin[block_count];
+	ArrayIDFunc<GeoPos>geo_pos(node_count);
+	tbb::parallel_for(0, first_node_count, [&](int x){ geo_pos[x] = get_first_node_geo_pos(x); });
+
+	std::vector<std::pair<int, int>>edge(block_edge_begin[block_count]);
+	tbb::parallel_for(0, block_count, [&](int b){
+		WritingEmitter emit;
+		emit.first_node = emit.next_node = block_node_begin[b];
+		emit.geo_pos = geo_pos.begin() + block_node_begin[b];
+		emit.next_edge = edge.data() + block_edge_begin[b];
+		for(int i=b*block_size; i<std::min(item_count, (b+1)*block_size); ++i)
+			generate(i, emit);
+	});
+
+	return build_generated_graph(edge, std::move(geo_pos));
+}
+
+//! A width x height grid.
+inline
+GeneratedGraph generate_grid_graph(int width, int height){
+	graph_generator_detail::check_grid_size(width, height);
+	const int node_count = width*height;
+
+	return generate_graph_in_parallel(
+		node_count, [&](int x)->GeoPos{ return {0.001*(x / width), 0.001*(x % width)}; },
+		node_count,
+		[&](int x, auto&emit){
+			if(x % width != 0)
+				emit.add_edge(x-1, x);
+			if(x >= width)
+				emit.add_edge(x-width, x);
+		}
+	);
+}
+
+//! A connected graph that resembles a road network without intermediate nodes:
+//! The nodes of a width x height grid are moved by up to a third of the grid
+//! spacing. A random spanning tree of the grid is kept together with every other
+//! grid edge with probability extra_edge_probability.
+inline
+GeneratedGraph generate_perturbed_grid_graph(int width, int height, double extra_edge_probability, std::uint64_t seed){
+	graph_generator_detail::check_grid_size(width, height);
+	const int node_count = width*height;
+	graph_generator_detail::PerturbedGrid grid(width, extra_edge_probability, seed);
+
+	return generate_graph_in_parallel(
+		node_count, [&](int x){ return grid.geo_pos(x); },
+		node_count,
+		[&](int x, auto&emit){
+			if(grid.has_left_edge(x))
+				emit.add_edge(x-1, x);
+			if(grid.has_up_edge(x))
+				emit.add_edge(x-width, x);
+		}
+	);
+}
+
+//! Places node_count nodes uniformly at random in a square and connects every
+//! node with its neighbor_count nearest neighbors. The nearest neighbors are only
+//! searched in the surrounding grid cells, which contain about 18 nodes. Like a
+//! Delaunay triangulation, the graph is planar-ish and has a small average degree,
+//! but it may be disconnected for a small neighbor_count. The nodes are numbered
+//! along the grid cells, such that nodes with close IDs are close in space.
+inline
+GeneratedGraph generate_random_geometric_graph(int node_count, int neighbor_count, std::uint64_t seed){
+	if(node_count <= 0)
+		throw std::runtime_error("The node count must be positive");
+	if(neighbor_count <= 0 || neighbor_count > 16)
+		throw std::runtime_error("The neighbor count must be between 1 and 16");
+
+	// Two nodes per cell on average and the same density as the grids.
+	const int cell_count_per_side = std::max(static_cast<int>(std::sqrt(node_count/2.0)), 1);
+	const long long cell_count = static_cast<long long>(cell_count_per_side)*cell_count_per_side;
+	const double side_length = 0.001*std::sqrt(static_cast<double>(node_count));
+
+	GeneratorRandomStream coordinate(seed, 0);
+	auto get_cell = [&](GeoPos p)->std::uint64_t{
+		long long cell_lat = std::min(static_cast<long long>(p.lat / side_length * cell_count_per_side), cell_count_per_side-1ll);
+		long long cell_lon = std::min(static_cast<long long>(p.lon / side_length * cell_count_per_side), cell_count_per_side-1ll);
+		return cell_lat*cell_count_per_side + cell_lon;
+	};
+
+	auto get_random_geo_pos = [&](std::uint64_t i)->GeoPos{
+		return {coordinate.real(2*i)*side_length, coordinate.real(2*i+1)*side_length};
+	};
+
+	// Sorting the cell of the i-th random node times node_count plus i numbers
+	// the nodes along the cells.
+	std::vector<std::uint64_t>node(node_count);
+	tbb::parallel_for(0, node_count, [&](int i){
+		node[i] = get_cell(get_random_geo_pos(i))*node_count + i;
+	});
+	tbb::parallel_sort(node.begin(), node.end());
+
+	ArrayIDFunc<GeoPos>geo_pos(node_count);
+	std::vector<int>cell_begin(cell_count+1);
+	tbb::parallel_for(0, node_count, [&](int x){
+		geo_pos[x] = get_random_geo_pos(node[x] % node_count);
+		long long prev_cell = x == 0 ? -1 : node[x-1] / node_count;
+		for(long long c=prev_cell+1; c<=static_cast<long long>(node[x] / node_count); ++c)
+			cell_begin[c] = x;
+	});
+	for(long long c=node[node_count-1] / node_count + 1; c<=cell_count; ++c)
+		cell_begin[c] = node_count;
+	node = std::vector<std::uint64_t>();
+
+	auto square = [](double a){ return a*a; };
+	auto squared_distance = [&](int x, int y){
+		return square(geo_pos(x).lat - geo_pos(y).lat) + square(geo_pos(x).lon - geo_pos(y).lon);
+	};
+	auto forall_nodes_in_surrounding_cells = [&](int x, const auto&f){
+		long long cell = get_cell(geo_pos(x));
+		long long cell_lat = cell / cell_count_per_side, cell_lon = cell % cell_count_per_side;
+		for(long long lat=std::max(cell_lat-1, 0ll); lat<=std::min(cell_lat+1, cell_count_per_side-1ll); ++lat){
+			long long row = lat*cell_count_per_side;
+			long long first_cell = row + std::max(cell_lon-1, 0ll);
+			long long last_cell = row + std::min(cell_lon+1, cell_count_per_side-1ll);
+			for(int y=cell_begin[first_cell]; y<cell_begin[last_cell+1]; ++y)
+				if(y != x)
+					f(y);
+		}
+	};
+
+	// The nearest neighbors of x are neighbor[x*neighbor_count] and onwards, padded with -1.
+	std::vector<int>neighbor(static_cast<std::size_t>(node_count)*neighbor_count);
+	tbb::parallel_for(0, node_count, [&](int x){
+		std::pair<double, int>closest[16];
+		int closest_count = 0;
+		forall_nodes_in_surrounding_cells(x, [&](int y){
+			std::pair<double, int>c = {squared_distance(x, y), y};
+			if(closest_count != neighbor_count)
+				closest[closest_count++] = c;
+			else if(c < closest[closest_count-1])
+				closest[closest_count-1] = c;
+			else
+				return;
+			for(int i=closest_count-1; i!=0 && closest[i] < closest[i-1]; --i)
+				std::swap(closest[i], closest[i-1]);
+		});
+		int*begin = neighbor.data() + static_cast<std::size_t>(x)*neighbor_count;
+		for(int i=0; i<neighbor_count; ++i)
+			begin[i] = i < closest_count ? closest[i].second : -1;
+	});
+
+	auto is_neighbor = [&](int x, int y){
+		const int*begin = neighbor.data() + static_cast<std::size_t>(x)*neighbor_count;
+		return std::find(begin, begin + neighbor_count, y) != begin + neighbor_count;
+	};
+
+	// If two nodes are nearest neighbors of each other, only the smaller adds the
+	// edge, such that no edge is added twice.
+	return generate_graph_in_parallel(
+		node_count, [&](int x){ return geo_pos(x); },
+		node_count,
+		[&](int x, auto&emit){
+			const int*begin = neighbor.data() + static_cast<std::size_t>(x)*neighbor_count;
+			for(const int*y=begin; y!=begin+neighbor_count && *y != -1; ++y)
+				if(x < *y || !is_neighbor(*y, x))
+					emit.add_edge(x, *y);
+		}
+	);
+}
+
+//! A connected graph with a highway hierarchy and long degree-two chains. The
+//! junctions form a perturbed grid of width x height nodes that keeps every
+//! non-tree edge with probability 1/2. Every road between two junctions is a
+//! chain of 0 to max_chain_length degree-two nodes. On level l in [1,
+//! level_count), every junction whose grid coordinates are multiples of 4^l is
+//! connected by a highway to the next such junction to its right and below. A
+//! highway is a chain of 0 to 4^l*max_chain_length degree-two nodes. The
+//! junctions are nodes 0 to width*height-1, followed by the chain nodes.
+inline
+GeneratedGraph generate_highway_graph(int width, int height, int level_count, int max_chain_length, std::uint64_t seed){
+	graph_generator_detail::check_grid_size(width, height);
+	if(level_count < 1)
+		throw std::runtime_error("There must be at least one level");
+	if(max_chain_length < 0)
+		throw std::runtime_error("The maximum chain length must not be negative");
+
+	const int junction_count = width*height;
+	graph_generator_detail::PerturbedGrid grid(width, 0.5, seed);
+	GeneratorRandomStream chain_length(seed, 3);
+
+	std::vector<int>level_step;
+	for(long long step = 4; static_cast<int>(level_step.size())+1 < level_count && step < std::max(width, height); step *= 4){
+		if(step*max_chain_length > std::numeric_limits<int>::max()/4)
+			throw std::runtime_error("The highway chains are too long");
+		level_step.push_back(step);
+	}
+
+	using graph_generator_detail::add_chain;
+	const int stream_count = 2 + 2*level_step.size();
+	return generate_graph_in_parallel(
+		junction_count, [&](int x){ return grid.geo_pos(x); },
+		junction_count,
+		[&](int x, auto&emit){
+			std::uint64_t key = static_cast<std::uint64_t>(x)*stream_count;
+			if(grid.has_left_edge(x))
+				add_chain(emit, x-1, grid.geo_pos(x-1), x, grid.geo_pos(x), chain_length.integer(key, 0, max_chain_length));
+			if(grid.has_up_edge(x))
+				add_chain(emit, x-width, grid.geo_pos(x-width), x, grid.geo_pos(x), chain_length.integer(key+1, 0, max_chain_length));
+
+			int column = x % width, row = x / width;
+			for(int l=0; l<static_cast<int>(level_step.size()); ++l){
+				int step = level_step[l];
+				if(column % step != 0 || row % step != 0)
+					continue;
+				int max_highway_chain_length = step*max_chain_length;
+				if(column >= step)
+					add_chain(emit, x-step, grid.geo_pos(x-step), x, grid.geo_pos(x), chain_length.integer(key+2+2*l, 0, max_highway_chain_length));
+				if(row >= step)
+					add_chain(emit, x-step*width, grid.geo_pos(x-step*width), x, grid.geo_pos(x), chain_length.integer(key+3+2*l, 0, max_highway_chain_length));
+			}
+		}
+	);
+}
+
+#endif
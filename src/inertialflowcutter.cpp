@@ -0,0 +1,229 @@
+#include "inertialflowcutter.h"
+
+#include "array_id_func.h"
+#include "id_func.h"
+#include "id_multi_func.h"
+#include "chain.h"
+#include "permutation.h"
+#include "preorder.h"
+#include "sort_arc.h"
+#include "geo_pos.h"
+#include "flow_cutter_config.h"
+#include "separator.h"
+#include "min_fill_in.h"
+
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <tbb/task_arena.h>
+
+struct ifc_context{
+	flow_cutter::Config config;
+	std::string error;
+};
+
+namespace{
+	// The console keeps its graph in global variables. The library works on a
+	// graph local to the call instead, such that it owns no global state.
+	struct Graph{
+		ArrayIDIDFunc tail, head;
+		ArrayIDFunc<GeoPos> geo_pos;
+		ArrayIDIDFunc original_position;
+
+		void permutate_nodes(const ArrayIDIDFunc&p){
+			auto inv_p = inverse_permutation(p);
+			head = chain(std::move(head), inv_p);
+			tail = chain(std::move(tail), inv_p);
+			geo_pos = chain(p, std::move(geo_pos));
+			original_position = chain(p, std::move(original_position));
+		}
+
+		void sort_arcs(){
+			auto p = sort_arcs_first_by_tail_second_by_head(tail, head);
+			tail = chain(p, std::move(tail));
+			head = chain(p, std::move(head));
+		}
+	};
+
+	// Builds the symmetric graph without loops and multi-arcs that the console
+	// obtains with add_back_arcs, remove_multi_arcs, and remove_loops. Its arcs are
+	// sorted by tail and head, just as in the console.
+	Graph build_symmetric_graph(
+		unsigned node_count, const unsigned*first_out, const unsigned*head,
+		const float*latitude, const float*longitude
+	){
+		if(node_count > static_cast<unsigned>(std::numeric_limits<int>::max()))
+			throw std::runtime_error("Too many nodes");
+		if(first_out == nullptr || (head == nullptr && first_out[node_count] != 0))
+			throw std::runtime_error("first_out and head must not be NULL");
+		if((latitude == nullptr) != (longitude == nullptr))
+			throw std::runtime_error("Either both or none of latitude and longitude must be NULL");
+		if(first_out[0] != 0)
+			throw std::runtime_error("first_out must start with 0");
+
+		// The whole input is validated before the arcs are read, such that no entry
+		// of first_out can lead to a read beyond head[first_out[node_count]-1].
+		for(unsigned x=0; x<node_count; ++x)
+			if(first_out[x] > first_out[x+1])
+				throw std::runtime_error("first_out must be sorted");
+		const unsigned input_arc_count = first_out[node_count];
+		for(unsigned xy=0; xy<input_arc_count; ++xy)
+			if(head[xy] >= node_count)
+				throw std::runtime_error("head contains a node id that is too large");
+
+		std::vector<std::uint64_t>arc;
+		for(unsigned x=0; x<node_count; ++x){
+			for(unsigned xy=first_out[x]; xy<first_out[x+1]; ++xy){
+				unsigned y = head[xy];
+				if(x != y){
+					arc.push_back((static_cast<std::uint64_t>(x) << 32) | y);
+					arc.push_back((static_cast<std::uint64_t>(y) << 32) | x);
+				}
+			}
+		}
+		std::sort(arc.begin(), arc.end());
+		arc.erase(std::unique(arc.begin(), arc.end()), arc.end());
+		if(arc.size() > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+			throw std::runtime_error("Too many arcs");
+
+		Graph g;
+		const int arc_count = arc.size();
+		const int int_node_count = node_count;
+		g.tail = ArrayIDIDFunc(arc_count, int_node_count);
+		g.head = ArrayIDIDFunc(arc_count, int_node_count);
+		for(int i=0; i<arc_count; ++i){
+			g.tail[i] = arc[i] >> 32;
+			g.head[i] = arc[i] & 0xFFFFFFFFu;
+		}
+
+		g.geo_pos = ArrayIDFunc<GeoPos>(int_node_count);
+		if(latitude != nullptr)
+			for(int x=0; x<int_node_count; ++x)
+				g.geo_pos[x] = {latitude[x], longitude[x]};
+		else
+			g.geo_pos.fill({0.0, 0.0});
+
+		g.original_position = identity_permutation(int_node_count);
+		return g; // NVRO
+	}
+
+	// Does the same as the console commands reorder_nodes_at_random,
+	// reorder_nodes_in_preorder, sort_arcs, and
+	// reorder_nodes_in_accelerated_flow_cutter_cch_order, such that the library
+	// computes the same orders as inertialflowcutter_order.py.
+	ArrayIDIDFunc compute_cch_order(Graph g, const flow_cutter::Config&config){
+		const int node_count = g.tail.image_count();
+
+		ArrayIDIDFunc perm = identity_permutation(node_count);
+		std::mt19937 rng(config.random_seed);
+		std::shuffle(perm.begin(), perm.end(), rng);
+		g.permutate_nodes(perm);
+
+		g.permutate_nodes(compute_preorder(compute_successor_function(g.tail, g.head)).first);
+		g.sort_arcs();
+
+		ArrayIDFunc<int>arc_weight(g.tail.preimage_count());
+		arc_weight.fill(0);
+
+		// A task arena limits the parallelism of this call only, while a
+		// tbb::global_control would affect the whole process.
+		ArrayIDIDFunc order;
+		tbb::task_arena arena(config.thread_count);
+		arena.execute([&]{
+			order = cch_order::compute_cch_graph_order(
+				g.tail, g.head, arc_weight,
+				flow_cutter::ComputeSeparator<flow_cutter_accelerated::CutterFactory, ArrayIDFunc<GeoPos>>(g.geo_pos, config)
+			);
+		});
+		g.permutate_nodes(order);
+		return std::move(g.original_position);
+	}
+
+	template<class F>
+	int catch_errors(ifc_context*ctx, const F&f){
+		if(ctx == nullptr)
+			return -1;
+		try{
+			ctx->error.clear();
+			return f();
+		}catch(std::exception&err){
+			ctx->error = err.what();
+		}catch(...){
+			ctx->error = "Unknown error";
+		}
+		return -1;
+	}
+}
+
+extern "C" {
+
+int ifc_get_api_version(void){
+	return IFC_API_VERSION;
+}
+
+ifc_context*ifc_create(void){
+	try{
+		return new ifc_context;
+	}catch(...){
+		return nullptr;
+	}
+}
+
+void ifc_destroy(ifc_context*ctx){
+	delete ctx;
+}
+
+int ifc_set(ifc_context*ctx, const char*name, const char*value){
+	return catch_errors(ctx, [&]{
+		if(name == nullptr || value == nullptr)
+			throw std::runtime_error("name and value must not be NULL");
+		ctx->config.set(name, value);
+		return 0;
+	});
+}
+
+int ifc_get(ifc_context*ctx, const char*name, char*buffer, unsigned buffer_size){
+	return catch_errors(ctx, [&]{
+		if(name == nullptr)
+			throw std::runtime_error("name must not be NULL");
+		std::string value = ctx->config.get(name);
+		if(buffer != nullptr && buffer_size != 0){
+			std::size_t n = std::min<std::size_t>(value.size(), buffer_size-1);
+			std::memcpy(buffer, value.data(), n);
+			buffer[n] = '\0';
+		}
+		return static_cast<int>(value.size());
+	});
+}
+
+const char*ifc_get_error(const ifc_context*ctx){
+	if(ctx == nullptr)
+		return "No context";
+	return ctx->error.c_str();
+}
+
+int ifc_compute_cch_order(
+	ifc_context*ctx,
+	unsigned node_count, const unsigned*first_out, const unsigned*head,
+	const float*latitude, const float*longitude,
+	unsigned*order
+){
+	return catch_errors(ctx, [&]{
+		if(order == nullptr && node_count != 0)
+			throw std::runtime_error("order must not be NULL");
+		auto result = compute_cch_order(
+			build_symmetric_graph(node_count, first_out, head, latitude, longitude),
+			ctx->config
+		);
+		for(unsigned i=0; i<node_count; ++i)
+			order[i] = result(i);
+		return 0;
+	});
+}
+
+}
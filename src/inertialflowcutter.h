@@ -0,0 +1,79 @@
+#ifndef INERTIALFLOWCUTTER_H
+#define INERTIALFLOWCUTTER_H
+
+/*
+ * C interface of libinertialflowcutter.
+ *
+ * The library computes nested dissection orders for customizable contraction
+ * hierarchies. Graphs are passed in the RoutingKit format: first_out has
+ * node_count+1 entries, and the out-arcs of node x are head[first_out[x]] to
+ * head[first_out[x+1]-1]. The arrays are only read and remain owned by the caller.
+ *
+ * All state lives in an ifc_context. Different contexts may be used concurrently
+ * from different threads. A single context must not be used concurrently.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#  ifdef INERTIALFLOWCUTTER_BUILD
+#    define IFC_API __declspec(dllexport)
+#  else
+#    define IFC_API __declspec(dllimport)
+#  endif
+#else
+#  define IFC_API __attribute__((visibility("default")))
+#endif
+
+/* Incremented whenever a function is added or its behavior changes. */
+#define IFC_API_VERSION 1
+
+typedef struct ifc_context ifc_context;
+
+/* Returns the IFC_API_VERSION that the library was built with. */
+IFC_API int ifc_get_api_version(void);
+
+/* Creates a context with the default flow cutter configuration. Returns NULL if
+ * out of memory. */
+IFC_API ifc_context*ifc_create(void);
+
+IFC_API void ifc_destroy(ifc_context*ctx);
+
+/* Sets a flow cutter configuration variable, such as "thread_count",
+ * "random_seed", "cutter_count", "max_imbalance" or
+ * "geo_pos_ordering_cutter_count". The names and values are the same as for the
+ * flow_cutter_set console command. Returns 0 on success. */
+IFC_API int ifc_set(ifc_context*ctx, const char*name, const char*value);
+
+/* Writes the value of a configuration variable as a null-terminated string into
+ * buffer. Returns the length of the value without the terminator, which may be
+ * larger than buffer_size-1 if the buffer is too small, or -1 on error. */
+IFC_API int ifc_get(ifc_context*ctx, const char*name, char*buffer, unsigned buffer_size);
+
+/* Returns a description of the last error of this context. The string remains
+ * valid until the next call with this context. */
+IFC_API const char*ifc_get_error(const ifc_context*ctx);
+
+/* Computes a CCH order of the graph. The graph need not be symmetric: Arcs are
+ * treated as undirected and loops and multi-arcs are ignored. latitude and
+ * longitude have node_count entries each and may both be NULL, in which case
+ * all nodes get the same position.
+ *
+ * The order is written to order, which must have room for node_count entries.
+ * order[i] is the i-th node to contract, which is the format of the
+ * RoutingKit node permutation. At most "thread_count" threads are used.
+ * Returns 0 on success. */
+IFC_API int ifc_compute_cch_order(
+	ifc_context*ctx,
+	unsigned node_count, const unsigned*first_out, const unsigned*head,
+	const float*latitude, const float*longitude,
+	unsigned*order
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
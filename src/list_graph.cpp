@@ -7,6 +7,12 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+#include <tbb/parallel_for.h>
 
 struct BinaryHeader{
 	int node_count, arc_count;
@@ -189,57 +195,240 @@ ListGraph load_binary_graph(const std::string&file_name){
 	return load_binary_file(file_name, load_binary_graph_impl);
 }
 
+// The DIMACS and METIS files of large graphs are too big to be parsed line by line
+// with a std::istringstream on a single thread. Therefore the loaders read the whole
+// file into memory, split it into chunks of whole lines, parse the chunks in parallel
+// into per-chunk arc arrays and concatenate these afterwards.
+
+static
+std::vector<char> read_whole_stream(std::istream&in){
+	const std::size_t block_size = 1<<20;
+	std::vector<char>buffer;
+	std::size_t size = 0;
+	for(;;){
+		buffer.resize(size + block_size);
+		std::streamsize read = in.rdbuf()->sgetn(buffer.data() + size, block_size);
+		size += read;
+		if(read != static_cast<std::streamsize>(block_size))
+			break;
+	}
+	buffer.resize(size);
+	return buffer; // NVRO
+}
+
+//! Extracts the line starting at pos without the line break and advances pos to the
+//! next line. Returns false if there is no line left, i.e., behaves like std::getline.
+static inline
+bool get_line(const char*&pos, const char*end, const char*&line_begin, const char*&line_end){
+	if(pos == end)
+		return false;
+	line_begin = pos;
+	line_end = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+	if(line_end == nullptr){
+		line_end = end;
+		pos = end;
+	}else{
+		pos = line_end + 1;
+	}
+	return true;
+}
+
+static inline
+bool is_space(char c){
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline
+bool is_digit(char c){
+	return '0' <= c && c <= '9';
+}
+
+//! Reads an int in the same way as std::istream's operator>> does, i.e., leading
+//! white space is skipped and reading stops at the first character that is no digit.
+//! Returns false if there is no number or if it does not fit into an int.
+static inline
+bool parse_int(const char*&pos, const char*end, int&x){
+	while(pos != end && is_space(*pos))
+		++pos;
+	bool is_negative = false;
+	if(pos != end && (*pos == '-' || *pos == '+')){
+		is_negative = *pos == '-';
+		++pos;
+	}
+	if(pos == end || !is_digit(*pos))
+		return false;
+	long long value = 0;
+	do{
+		value = 10*value + (*pos - '0');
+		if(value > static_cast<long long>(std::numeric_limits<int>::max()) + 1)
+			return false;
+		++pos;
+	}while(pos != end && is_digit(*pos));
+	if(is_negative)
+		value = -value;
+	if(value > std::numeric_limits<int>::max())
+		return false;
+	x = static_cast<int>(value);
+	return true;
+}
+
+//! Reads a white space separated token and returns whether it is equal to token.
+//! Returns false if there is no token.
+static inline
+bool parse_token(const char*&pos, const char*end, const char*token, bool&is_equal){
+	while(pos != end && is_space(*pos))
+		++pos;
+	const char*token_begin = pos;
+	while(pos != end && !is_space(*pos))
+		++pos;
+	if(token_begin == pos)
+		return false;
+	std::size_t token_size = std::strlen(token);
+	is_equal = static_cast<std::size_t>(pos - token_begin) == token_size && std::memcmp(token_begin, token, token_size) == 0;
+	return true;
+}
+
+//! Splits [begin, end) into chunks of whole lines. Chunk i is [chunk_begin[i], chunk_begin[i+1]).
+static
+std::vector<const char*> split_into_line_chunks(const char*begin, const char*end){
+	const std::size_t min_chunk_size = 1<<20;
+	std::size_t size = end - begin;
+	std::size_t chunk_count = std::max<std::size_t>(1, size / min_chunk_size);
+
+	std::vector<const char*>chunk_begin(chunk_count+1);
+	chunk_begin[0] = begin;
+	for(std::size_t i=1; i<chunk_count; ++i){
+		const char*pos = std::max(begin + i*(size/chunk_count), chunk_begin[i-1]);
+		const char*line_break = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+		chunk_begin[i] = line_break == nullptr ? end : line_break + 1;
+	}
+	chunk_begin[chunk_count] = end;
+	return chunk_begin; // NVRO
+}
+
+namespace{
+	//! The first error in a chunk. The message is message_begin + global line number + message_end.
+	struct ChunkParseError{
+		int line_in_chunk = 0;
+		std::string message_begin, message_end;
+
+		bool has_error()const{
+			return line_in_chunk != 0;
+		}
+	};
+
+	struct ChunkArcs{
+		int line_count = 0;
+		int node_count = 0;
+		std::vector<int>tail, head, arc_weight, node_weight;
+		ChunkParseError error;
+	};
+}
+
+//! Throws the error of the first chunk that has one. line_offset is the number of
+//! lines in front of the first chunk.
+static
+void throw_first_chunk_parse_error(const std::vector<ChunkArcs>&chunk, int line_offset){
+	for(auto&c:chunk){
+		if(c.error.has_error())
+			throw std::runtime_error(c.error.message_begin + std::to_string(line_offset + c.error.line_in_chunk) + c.error.message_end);
+		line_offset += c.line_count;
+	}
+}
+
 static
 ListGraph load_dimacs_graph_impl(std::istream&in){
+	std::vector<char>buffer = read_whole_stream(in);
+	const char*pos = buffer.data(), *end = buffer.data() + buffer.size();
+	const char*line_begin, *line_end;
+
 	ListGraph graph;
-	std::string line;
-	int line_num = 0;
-	int next_arc = 0;
+	int header_line_num = 0;
 
 	bool was_header_read = false;
-	while(std::getline(in, line)){
-		++line_num;
-		if(line.empty() || line[0] == 'c')
+	while(get_line(pos, end, line_begin, line_end)){
+		++header_line_num;
+		if(line_begin == line_end || *line_begin == 'c')
 			continue;
 
-		std::istringstream lin(line);
-		if(!was_header_read){
-			was_header_read = true;
-			std::string p, sp;
-			int node_count;
-			int arc_count;
-			if(!(lin >> p >> sp >> node_count >> arc_count))
-				throw std::runtime_error("Can not parse header in dimacs file.");
-			if(p != "p" || sp != "sp" || node_count < 0 || arc_count < 0)
-				throw std::runtime_error("Invalid header in dimacs file.");
-			graph = ListGraph(node_count, arc_count);
-		}else{
-			std::string a;
+		was_header_read = true;
+		std::istringstream lin(std::string(line_begin, line_end));
+		std::string p, sp;
+		int node_count;
+		int arc_count;
+		if(!(lin >> p >> sp >> node_count >> arc_count))
+			throw std::runtime_error("Can not parse header in dimacs file.");
+		if(p != "p" || sp != "sp" || node_count < 0 || arc_count < 0)
+			throw std::runtime_error("Invalid header in dimacs file.");
+		graph = ListGraph(node_count, arc_count);
+		break;
+	}
+
+	if(!was_header_read){
+		graph.node_weight.fill(0);
+		return graph; // NVRO
+	}
+
+	const int node_count = graph.node_count();
+	std::vector<const char*>chunk_begin = split_into_line_chunks(pos, end);
+	std::vector<ChunkArcs>chunk(chunk_begin.size()-1);
+
+	tbb::parallel_for(std::size_t(0), chunk.size(), [&](std::size_t i){
+		ChunkArcs&c = chunk[i];
+		const char*pos = chunk_begin[i], *end = chunk_begin[i+1];
+		const char*line_begin, *line_end;
+		while(get_line(pos, end, line_begin, line_end)){
+			++c.line_count;
+			if(line_begin == line_end || *line_begin == 'c')
+				continue;
+
+			const char*p = line_begin;
+			bool is_a;
 			int h, t, w;
-			if(!(lin >> a >> t >> h >> w))
-				throw std::runtime_error("Can not parse line num "+std::to_string(line_num)+" \""+line+"\" in dimacs file.");
+			if(!parse_token(p, line_end, "a", is_a) || !parse_int(p, line_end, t) || !parse_int(p, line_end, h) || !parse_int(p, line_end, w)){
+				c.error.line_in_chunk = c.line_count;
+				c.error.message_begin = "Can not parse line num ";
+				c.error.message_end = " \""+std::string(line_begin, line_end)+"\" in dimacs file.";
+				return;
+			}
 			--h;
 			--t;
-			if(a != "a" || h < 0 || h >= graph.node_count() || t < 0 || t >= graph.node_count() || w < 0)
-				throw std::runtime_error("Invalid arc in line num "+std::to_string(line_num)+" \""+line+"\" in dimacs file.");
-			if(next_arc < graph.arc_count()){
-				graph.head[next_arc] = h;
-				graph.tail[next_arc] = t;
-				graph.arc_weight[next_arc] = w;
+			if(!is_a || h < 0 || h >= node_count || t < 0 || t >= node_count || w < 0){
+				c.error.line_in_chunk = c.line_count;
+				c.error.message_begin = "Invalid arc in line num ";
+				c.error.message_end = " \""+std::string(line_begin, line_end)+"\" in dimacs file.";
+				return;
 			}
-			++next_arc;
+			c.tail.push_back(t);
+			c.head.push_back(h);
+			c.arc_weight.push_back(w);
 		}
-	}
+	});
 
-	if(next_arc != graph.arc_count())
-		throw std::runtime_error("The arc count in the header ("+std::to_string(graph.arc_count())+") does not correspond with the actual number of arcs ("+std::to_string(next_arc)+").");
+	throw_first_chunk_parse_error(chunk, header_line_num);
+
+	std::vector<long long>chunk_first_arc(chunk.size()+1);
+	chunk_first_arc[0] = 0;
+	for(std::size_t i=0; i<chunk.size(); ++i)
+		chunk_first_arc[i+1] = chunk_first_arc[i] + chunk[i].tail.size();
+	long long parsed_arc_count = chunk_first_arc.back();
+
+	if(parsed_arc_count != graph.arc_count())
+		throw std::runtime_error("The arc count in the header ("+std::to_string(graph.arc_count())+") does not correspond with the actual number of arcs ("+std::to_string(parsed_arc_count)+").");
+
+	std::vector<char>().swap(buffer);
+
+	tbb::parallel_for(std::size_t(0), chunk.size(), [&](std::size_t i){
+		std::copy(chunk[i].tail.begin(), chunk[i].tail.end(), graph.tail.begin() + chunk_first_arc[i]);
+		std::copy(chunk[i].head.begin(), chunk[i].head.end(), graph.head.begin() + chunk_first_arc[i]);
+		std::copy(chunk[i].arc_weight.begin(), chunk[i].arc_weight.end(), graph.arc_weight.begin() + chunk_first_arc[i]);
+	});
 
 	graph.node_weight.fill(0);
 
 	return graph; // NVRO
 }
 
-
 ListGraph load_dimacs_graph(const std::string&file_name){
 	return load_cached_text_file(file_name, "dimacs", load_dimacs_graph_impl, load_binary_graph_impl, 
 		[](std::ostream&out, const ListGraph&g){
@@ -316,100 +505,183 @@ ListGraph uncached_load_color_dimacs_graph(const std::string&file_name){
 
 
 
+static inline
+bool is_metis_comment(const char*line_begin, const char*line_end){
+	return line_begin != line_end && *line_begin == '%';
+}
+
+//! Returns the line number within [pos, end) of the line that describes the node
+//! with the given id, counted from the first node in [pos, end).
+static
+int find_line_of_metis_node(const char*pos, const char*end, int node){
+	const char*line_begin, *line_end;
+	int line_num = 0;
+	while(get_line(pos, end, line_begin, line_end)){
+		++line_num;
+		if(!is_metis_comment(line_begin, line_end) && node-- == 0)
+			return line_num;
+	}
+	return line_num;
+}
+
 static
 ListGraph load_metis_graph_impl(std::istream&in){
+	std::vector<char>buffer = read_whole_stream(in);
+	const char*pos = buffer.data(), *end = buffer.data() + buffer.size();
+	const char*line_begin, *line_end;
 
 	ListGraph g;
 
-	std::string line;
-	int line_num = 0;
+	int header_line_num = 0;
 	bool header_read = false;
 
-	int next_node_id = 0;
-	int next_arc_id = 0;
-
-	int node_count, arc_count;
+	int node_count = 0, arc_count = 0;
 
 	bool has_arc_weights = false;
 	bool has_node_weights = false;
 
 	try{
-		while(std::getline(in, line)){
-			++line_num;
-			if(!line.empty() && line.front() == '%')
+		while(get_line(pos, end, line_begin, line_end)){
+			++header_line_num;
+			if(is_metis_comment(line_begin, line_end))
 				continue;
-			std::istringstream line_in(line);
-			if(!header_read){
-				header_read = true;
-			
-				if(!(line_in >> node_count >> arc_count))
-					throw std::runtime_error("Can not read header" );
-				if(node_count < 0)
-					throw std::runtime_error("node_count must be non-negative; it is "+std::to_string(node_count));
-				if(arc_count < 0)
-					throw std::runtime_error("half_arc_count must be non-negative; it is "+std::to_string(arc_count));
-				arc_count *= 2;
-
-				std::string has_weight_num;
-				if(line_in >> has_weight_num){
-					if(has_weight_num == "001" || has_weight_num == "1"){
-						has_arc_weights = true;
-					}else if(has_weight_num == "000" || has_weight_num == "0"){
-						has_arc_weights = false;
-					}else if(has_weight_num == "010"){
-						has_node_weights = true;
-					}else if(has_weight_num == "011"){
-						has_node_weights = true;
-						has_arc_weights = true;
-					}else
-						throw std::runtime_error("The has_weight parameter in the header must be 0 or 1.");
-
-					std::string ignore;
-					if(line_in >> ignore)
-						throw std::runtime_error("Header must only contain a 2 or 3 integers");
-				}
+			header_read = true;
+
+			std::istringstream line_in(std::string(line_begin, line_end));
+			if(!(line_in >> node_count >> arc_count))
+				throw std::runtime_error("Can not read header" );
+			if(node_count < 0)
+				throw std::runtime_error("node_count must be non-negative; it is "+std::to_string(node_count));
+			if(arc_count < 0)
+				throw std::runtime_error("half_arc_count must be non-negative; it is "+std::to_string(arc_count));
+			arc_count *= 2;
+
+			std::string has_weight_num;
+			if(line_in >> has_weight_num){
+				if(has_weight_num == "001" || has_weight_num == "1"){
+					has_arc_weights = true;
+				}else if(has_weight_num == "000" || has_weight_num == "0"){
+					has_arc_weights = false;
+				}else if(has_weight_num == "010"){
+					has_node_weights = true;
+				}else if(has_weight_num == "011"){
+					has_node_weights = true;
+					has_arc_weights = true;
+				}else
+					throw std::runtime_error("The has_weight parameter in the header must be 0 or 1.");
+
+				std::string ignore;
+				if(line_in >> ignore)
+					throw std::runtime_error("Header must only contain a 2 or 3 integers");
+			}
 
-				
-				g = ListGraph(node_count, arc_count);
-			}else{
-				if(next_node_id == node_count)
-					throw std::runtime_error("More nodes than claimed in the header");
-				int x;
-
-				if(has_node_weights){
-					if(!(line_in >> g.node_weight[next_node_id])){
-						throw std::runtime_error("Cannot read node weight");
-					}
-				}
+			g = ListGraph(node_count, arc_count);
+			break;
+		}
+	}catch(std::runtime_error& err){
+		throw std::runtime_error(std::string(err.what()) + " in line "+std::to_string(header_line_num));
+	}
+
+	if(!header_read)
+		return g; // NVRO
 
-				while(line_in >> x){
-					int weight = 1;
-					if(has_arc_weights){
-						if(!(line_in >> weight))
-							throw std::runtime_error("Missing weight for arc");
-					}
-
-					if(next_arc_id == arc_count)
-						throw std::runtime_error("More arcs than claimed in the header");
-					
-					--x;
-					g.head[next_arc_id] = x;
-					g.tail[next_arc_id] = next_node_id;
-					g.arc_weight[next_arc_id] = weight;
-					++next_arc_id;
+	std::vector<const char*>chunk_begin = split_into_line_chunks(pos, end);
+	std::vector<ChunkArcs>chunk(chunk_begin.size()-1);
+
+	tbb::parallel_for(std::size_t(0), chunk.size(), [&](std::size_t i){
+		ChunkArcs&c = chunk[i];
+		const char*pos = chunk_begin[i], *end = chunk_begin[i+1];
+		const char*line_begin, *line_end;
+
+		auto fail = [&](const char*message){
+			c.error.line_in_chunk = c.line_count;
+			c.error.message_begin = std::string(message) + " in line ";
+		};
+
+		while(get_line(pos, end, line_begin, line_end)){
+			++c.line_count;
+			if(is_metis_comment(line_begin, line_end))
+				continue;
+
+			const char*p = line_begin;
+			if(has_node_weights){
+				int w;
+				if(!parse_int(p, line_end, w))
+					return fail("Cannot read node weight");
+				c.node_weight.push_back(w);
+			}
+
+			int x;
+			while(parse_int(p, line_end, x)){
+				int weight = 1;
+				if(has_arc_weights){
+					if(!parse_int(p, line_end, weight))
+						return fail("Missing weight for arc");
 				}
-				++next_node_id;
+				if(x < 1 || x > node_count)
+					return fail("Arc head is no valid node id");
+
+				c.tail.push_back(c.node_count);
+				c.head.push_back(x-1);
+				c.arc_weight.push_back(weight);
 			}
+			++c.node_count;
+		}
+	});
+
+	// Report the first error in file order. A node or an arc beyond the counts in the
+	// header is an error in the line where it appears.
+	int line_offset = header_line_num;
+	long long first_node = 0, first_arc = 0;
+	std::vector<int>chunk_first_node(chunk.size()+1);
+	std::vector<long long>chunk_first_arc(chunk.size()+1);
+	for(std::size_t i=0; i<chunk.size(); ++i){
+		const ChunkArcs&c = chunk[i];
+		chunk_first_node[i] = first_node;
+		chunk_first_arc[i] = first_arc;
+
+		// A node whose line has an error was reached by the parser, too.
+		long long reached_node_count = c.node_count + (c.error.has_error() ? 1 : 0);
+		bool too_many_nodes = first_node + reached_node_count > node_count;
+		bool too_many_arcs = first_arc + static_cast<long long>(c.tail.size()) > arc_count;
+		if(too_many_nodes || too_many_arcs){
+			int extra_node = too_many_nodes ? node_count - first_node : std::numeric_limits<int>::max();
+			int node_of_extra_arc = too_many_arcs ? c.tail[arc_count - first_arc] : std::numeric_limits<int>::max();
+			int line = line_offset + find_line_of_metis_node(chunk_begin[i], chunk_begin[i+1], std::min(extra_node, node_of_extra_arc));
+			if(extra_node <= node_of_extra_arc)
+				throw std::runtime_error("More nodes than claimed in the header in line "+std::to_string(line));
+			else
+				throw std::runtime_error("More arcs than claimed in the header in line "+std::to_string(line));
 		}
+		if(c.error.has_error())
+			throw std::runtime_error(c.error.message_begin + std::to_string(line_offset + c.error.line_in_chunk) + c.error.message_end);
 
-	}catch(std::runtime_error& err){
-		throw std::runtime_error(std::string(err.what()) + " in line "+std::to_string(line_num));
+		line_offset += c.line_count;
+		first_node += c.node_count;
+		first_arc += c.tail.size();
 	}
-	if(next_node_id != node_count)
+	chunk_first_node[chunk.size()] = first_node;
+	chunk_first_arc[chunk.size()] = first_arc;
+
+	if(first_node != node_count)
 		throw std::runtime_error("Less nodes than claimed in the header");
-	if(next_arc_id != arc_count)
+	if(first_arc != arc_count)
 		throw std::runtime_error("Less arcs than claimed in the header");
 
+	std::vector<char>().swap(buffer);
+
+	tbb::parallel_for(std::size_t(0), chunk.size(), [&](std::size_t i){
+		const ChunkArcs&c = chunk[i];
+		int node_offset = chunk_first_node[i];
+		auto arc_offset = chunk_first_arc[i];
+		for(std::size_t j=0; j<c.tail.size(); ++j)
+			g.tail[arc_offset + j] = node_offset + c.tail[j];
+		std::copy(c.head.begin(), c.head.end(), g.head.begin() + arc_offset);
+		std::copy(c.arc_weight.begin(), c.arc_weight.end(), g.arc_weight.begin() + arc_offset);
+		if(has_node_weights)
+			std::copy(c.node_weight.begin(), c.node_weight.end(), g.node_weight.begin() + node_offset);
+	});
+
 	if(!has_node_weights)
 		g.node_weight.fill(1);
 
@@ -12,7 +12,11 @@
 #include "multi_arc.h"
 #include "id_multi_func.h"
 #include "preorder.h"
+#include "order_checkpoint.h"
+#include "separator_hierarchy.h"
+#include "order_trace.h"
 #include <vector>
+#include <deque>
 
 #ifndef NDEBUG
 #include "union_find.h"
@@ -24,6 +28,10 @@
 #include <functional>
 #include <tbb/tick_count.h>
 #include <tbb/parallel_invoke.h>
+#include <tbb/task_arena.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_scan.h>
+#include <tbb/parallel_for.h>
 
 
 
@@ -81,14 +89,15 @@ namespace cch_order{
 	}
 
 	// Computes an optimal order for a trivial graph. If the input graph is not trivial, then the task is forwarded to the compute_non_trivial_graph_order functor parameter.
-	// A graph is trivial if it is a clique or a tree.
+	// A graph is trivial if it is a clique or a tree. Trivial graphs are recorded in the trace.
 	//	
 	// Precondition: the graph is connected
 	template<class ComputeNonTrivialGraphOrder>
 	ArrayIDIDFunc compute_trivial_graph_order_if_graph_is_trivial(
 		ArrayIDIDFunc tail, ArrayIDIDFunc head, 
 		ArrayIDIDFunc input_node_id,
-		ArrayIDFunc<int>arc_weight, const ComputeNonTrivialGraphOrder&compute_non_trivial_graph_order
+		ArrayIDFunc<int>arc_weight, const ComputeNonTrivialGraphOrder&compute_non_trivial_graph_order,
+		TraceContext trace = TraceContext()
 	){
 		const int node_count = tail.image_count();
 		const int arc_count = tail.preimage_count();
@@ -104,9 +113,13 @@ namespace cch_order{
 
 
 		if(is_clique || has_no_arcs){
+			TraceScope scope(trace, OrderTrace::Reducer::trivial, node_count, arc_count);
 			order = id_id_func(node_count, input_node_id.image_count(), [&](int x){return input_node_id(x);});
+			scope.finish();
 		}else if(is_tree){
+			TraceScope scope(trace, OrderTrace::Reducer::trivial, node_count, arc_count);
 			order = compute_tree_graph_order(std::move(tail), std::move(head), std::move(input_node_id));
+			scope.finish();
 		}else {
 			order = compute_non_trivial_graph_order(std::move(tail), std::move(head), std::move(input_node_id), std::move(arc_weight));
 		}
@@ -121,13 +134,15 @@ namespace cch_order{
 	// If the relative component order does not matter, then let should_place_node_at_the_end_of_the_order always return false.
 	//
 	// compute_connected_graph_order should order the nodes in each component. The order should map node IDs in the graph that is given to input node IDs.
+	// Trivial components are recorded in component_trace.
 	template<class ComputeConnectedGraphOrder, class ShouldPlaceNodeAtTheEndOfTheOrder>
 	ArrayIDIDFunc reorder_nodes_in_preorder_and_compute_unconnected_graph_order_if_component_is_non_trivial(
 		ArrayIDIDFunc tail, ArrayIDIDFunc head, 
 		ArrayIDIDFunc input_node_id,
 		ArrayIDFunc<int> arc_weight,
 		const ComputeConnectedGraphOrder&compute_connected_graph_order,
-		const ShouldPlaceNodeAtTheEndOfTheOrder&should_place_node_at_the_end_of_the_order
+		const ShouldPlaceNodeAtTheEndOfTheOrder&should_place_node_at_the_end_of_the_order,
+		TraceContext component_trace = TraceContext()
 	){
 
 		const int node_count = tail.image_count();
@@ -140,23 +155,23 @@ namespace cch_order{
 		//TODO if preorder returns just one component skip all of the reordering stuff. actually we should figure out  a way to do biconnected immediately and never do connected components. saves another second
 
 		if (num_components == 1) {
-			return compute_trivial_graph_order_if_graph_is_trivial(std::move(tail), std::move(head), std::move(input_node_id), std::move(arc_weight), compute_connected_graph_order);
+			return compute_trivial_graph_order_if_graph_is_trivial(std::move(tail), std::move(head), std::move(input_node_id), std::move(arc_weight), compute_connected_graph_order, component_trace);
 		}
 
 		{
 			auto inv_preorder = inverse_permutation(preorder);
 			tail = chain(std::move(tail), inv_preorder);
 			head = chain(std::move(head), inv_preorder);
-			input_node_id = chain(preorder, std::move(input_node_id));
+			permute_preimage_in_place(preorder, input_node_id);
 		}
 
 		// We then sort the arcs accordingly
 
 		{
 			auto p = sort_arcs_first_by_tail_second_by_head(tail, head);
-			tail = chain(p, std::move(tail));
-			head = chain(p, std::move(head));
-			arc_weight = chain(p, std::move(arc_weight));
+			permute_preimage_in_place(p, tail);
+			permute_preimage_in_place(p, head);
+			permute_preimage_in_place(p, arc_weight);
 		}
 
 		assert(is_symmetric(tail, head));
@@ -193,6 +208,10 @@ namespace cch_order{
 		struct SubProblem {
 			int node_begin, node_end, arc_begin, arc_end, sub_order_begin;
 			int node_count() const { return node_end - node_begin; }
+			int arc_count() const { return arc_end - arc_begin; }
+
+			ArrayIDIDFunc tail, head, input_node_id;
+			ArrayIDFunc<int> arc_weight;
 		};
 		std::vector<SubProblem> big, small;
 
@@ -208,6 +227,12 @@ namespace cch_order{
 				component_begin.set(tail(i), false);
 
 		{
+			auto add_sub_problem = [&](int node_begin, int node_end, int arc_begin, int arc_end){
+				int sub_order_begin = get_sub_order_begin(node_begin, node_end);
+				SubProblem sp = {node_begin, node_end, arc_begin, arc_end, sub_order_begin, {}, {}, {}, {}};
+				if (sp.node_count() > TASK_SPAWN_CUTOFF) big.push_back(std::move(sp)); else small.push_back(std::move(sp));
+			};
+
 			int node_begin = 0;
 			int arc_begin = 0;
 			for (int node_end = 1; node_end < node_count; ++node_end) {
@@ -216,24 +241,20 @@ namespace cch_order{
 					while (arc_end < arc_count && tail(arc_end) < node_end) {
 						++arc_end;
 					}
-					int sub_order_begin = get_sub_order_begin(node_begin, node_end);
-					SubProblem sp = {node_begin, node_end, arc_begin, arc_end, sub_order_begin};
-					if (sp.node_count() > TASK_SPAWN_CUTOFF) big.push_back(sp); else small.push_back(sp);
+					add_sub_problem(node_begin, node_end, arc_begin, arc_end);
 					node_begin = node_end;
 					arc_begin = arc_end;
 				}
 			}
 
-			int sub_order_begin = get_sub_order_begin(node_begin, node_count);
-			SubProblem sp = {node_begin, node_count, arc_begin, arc_count, sub_order_begin};
-			if (sp.node_count() > TASK_SPAWN_CUTOFF) big.push_back(sp); else small.push_back(sp);
+			add_sub_problem(node_begin, node_count, arc_begin, arc_count);
 		}
 
 
 #ifndef NDEBUG
 			std::vector<bool> nodes_covered((unsigned long) node_count, false);
 			std::vector<bool> order_covered((unsigned long) node_count, false);
-			auto cover = [&](const SubProblem sp) {
+			auto cover = [&](const SubProblem&sp) {
 				for (int u = sp.node_begin; u < sp.node_end; ++u) {
 					assert(!nodes_covered[u]);
 					nodes_covered[u] = true;
@@ -244,51 +265,90 @@ namespace cch_order{
 					order_covered[u] = true;
 				}
 			};
-			for (const SubProblem sp : big)
+			for (const SubProblem&sp : big)
 				cover(sp);
-			for (const SubProblem sp : small)
+			for (const SubProblem&sp : small)
 				cover(sp);
 			assert(std::all_of(nodes_covered.begin(), nodes_covered.end(), [](const bool& x) { return x; }));
 			assert(std::all_of(order_covered.begin(), order_covered.end(), [](const bool& x) { return x; }));
 #endif
 
-		//auto on_new_component = [&tail, &head, &input_node_id, &arc_weight, &order, &compute_connected_graph_order](SubProblem& sub_problem){
-		auto on_new_component = [&](SubProblem sub_problem){
-			int node_begin = sub_problem.node_begin; int node_end = sub_problem.node_end;
-			int arc_begin = sub_problem.arc_begin; int arc_end = sub_problem.arc_end;
-			int sub_order_begin = sub_problem.sub_order_begin;
-			auto sub_node_count = node_end - node_begin;
-			auto sub_arc_count = arc_end - arc_begin;
+		// The component that contains node 0 occupies a prefix of the arrays and therefore
+		// takes them over, shrunk to its size. Every other component gets a copy of its range.
+		// All copies are made before any component is ordered, as ordering the prefix
+		// component modifies and may reallocate the arrays.
+		auto extract_sub_graph = [&](SubProblem&sp){
+			int node_begin = sp.node_begin;
+			int arc_begin = sp.arc_begin;
 
-			auto sub_tail = id_id_func(
-					sub_arc_count, sub_node_count,
+			sp.tail = id_id_func(
+					sp.arc_count(), sp.node_count(),
 					[&](int x){
 						return tail(arc_begin + x) - node_begin;
 					}
 			);
-			auto sub_head = id_id_func(
-					sub_arc_count, sub_node_count,
+			sp.head = id_id_func(
+					sp.arc_count(), sp.node_count(),
 					[&](int x){
 						return head(arc_begin + x) - node_begin;
 					}
 			);
-			auto sub_input_node_id = id_id_func(
-					sub_node_count, input_node_id.image_count(),
+			sp.input_node_id = id_id_func(
+					sp.node_count(), input_node_id.image_count(),
 					[&](int x){
 						return input_node_id(node_begin + x);
 					}
 			);
-			auto sub_arc_weight = id_func(
-					sub_arc_count,
+			sp.arc_weight = id_func(
+					sp.arc_count(),
 					[&](int x){
-						return arc_weight(x + arc_begin);
+						return arc_weight(arc_begin + x);
 					}
 			);
-			assert(is_symmetric(sub_tail, sub_head));
-			assert(!has_multi_arcs(sub_tail, sub_head));
-			assert(is_loop_free(sub_tail, sub_head));
+		};
+
+		auto take_over_sub_graph = [&](SubProblem&sp){
+			assert(sp.node_begin == 0 && sp.arc_begin == 0);
+			tail.shrink_preimage_count(sp.arc_end);
+			tail.set_image_count(sp.node_end);
+			head.shrink_preimage_count(sp.arc_end);
+			head.set_image_count(sp.node_end);
+			input_node_id.shrink_preimage_count(sp.node_end);
+			arc_weight.shrink_preimage_count(sp.arc_end);
+
+			sp.tail = std::move(tail);
+			sp.head = std::move(head);
+			sp.input_node_id = std::move(input_node_id);
+			sp.arc_weight = std::move(arc_weight);
+		};
+
+		{
+			SubProblem*prefix = nullptr;
+			for (auto*sub_problems : {&big, &small}) {
+				for (SubProblem&sp : *sub_problems) {
+					if (sp.node_begin == 0)
+						prefix = &sp;
+					else
+						extract_sub_graph(sp);
+				}
+			}
+			assert(prefix != nullptr);
+			take_over_sub_graph(*prefix);
+		}
+
+		auto on_new_component = [&](SubProblem&sub_problem){
+			int sub_order_begin = sub_problem.sub_order_begin;
+			auto sub_node_count = sub_problem.node_count();
+
+			assert(is_symmetric(sub_problem.tail, sub_problem.head));
+			assert(!has_multi_arcs(sub_problem.tail, sub_problem.head));
+			assert(is_loop_free(sub_problem.tail, sub_problem.head));
 
-			auto sub_order = compute_trivial_graph_order_if_graph_is_trivial(sub_tail, sub_head, sub_input_node_id, sub_arc_weight, compute_connected_graph_order);
+			auto sub_order = compute_trivial_graph_order_if_graph_is_trivial(
+				std::move(sub_problem.tail), std::move(sub_problem.head),
+				std::move(sub_problem.input_node_id), std::move(sub_problem.arc_weight),
+				compute_connected_graph_order, component_trace
+			);
 			for (int i = 0; i < sub_node_count; ++i) {
 				order[sub_order_begin + i] = sub_order(i);
 			}
@@ -298,12 +358,12 @@ namespace cch_order{
 
 		tbb::task_group tg;
 		if (big.size() == 1 && small.size() < 200000) {
-			small.push_back(big.front());
+			small.push_back(std::move(big.front()));
 			big.clear();
 		}
 		//std::sort(big.begin(), big.end(), [](const auto& a, const auto& b) { return a.node_count() > b.node_count(); });
-		for (const SubProblem sp : big) {
-			tg.run(std::bind(on_new_component, sp));
+		for (SubProblem&sp : big) {
+			tg.run(std::bind(on_new_component, std::ref(sp)));
 		}
 		tg.run_and_wait([&]() {
 			std::for_each(small.begin(), small.end(), on_new_component);
@@ -398,15 +458,15 @@ namespace cch_order{
 			auto inv_preorder = inverse_permutation(preorder);
 			tail = chain(std::move(tail), inv_preorder);
 			head = chain(std::move(head), inv_preorder);
-			input_node_id = chain(preorder, std::move(input_node_id));
+			permute_preimage_in_place(preorder, input_node_id);
 		}
 
 		{
 			auto p = sort_arcs_first_by_tail_second_by_head(tail, head);
-			tail = chain(p, std::move(tail));
-			head = chain(p, std::move(head));
-			arc_weight = chain(p, std::move(arc_weight));
-			input_arc_id = chain(p, std::move(input_arc_id));
+			permute_preimage_in_place(p, tail);
+			permute_preimage_in_place(p, head);
+			permute_preimage_in_place(p, arc_weight);
+			permute_preimage_in_place(p, input_arc_id);
 		}
 
 		auto get_sub_order_begin = [&](int arc_begin, int arc_end) {
@@ -545,7 +605,8 @@ namespace cch_order{
 		ArrayIDIDFunc input_node_id,
 		ArrayIDFunc<int> arc_weight, 
 		const ComputeSeparator&compute_separator,
-		const ComputePartOrder&compute_graph_part_order
+		const ComputePartOrder&compute_graph_part_order,
+		TraceContext part_trace = TraceContext()
 	){
 		const int node_count = tail.image_count();
 		const int arc_count = tail.preimage_count();
@@ -579,7 +640,7 @@ namespace cch_order{
 		return reorder_nodes_in_preorder_and_compute_unconnected_graph_order_if_component_is_non_trivial(
 			std::move(tail), std::move(head), 
 			std::move(input_node_id), std::move(arc_weight), 
-			compute_graph_part_order, std::move(in_separator)
+			compute_graph_part_order, std::move(in_separator), part_trace
 		);
 	}
 
@@ -694,11 +755,14 @@ namespace cch_order{
 	ArrayIDIDFunc compute_graph_order_with_degree_two_chain_at_the_begin(
 		ArrayIDIDFunc tail, ArrayIDIDFunc head,
 		ArrayIDIDFunc input_node_id, ArrayIDFunc<int>arc_weight,
-		const ComputeCoreGraphOrder&compute_core_graph_order
+		const ComputeCoreGraphOrder&compute_core_graph_order,
+		TraceContext trace = TraceContext()
 	){
 		const int node_count = tail.image_count();
 		int arc_count = tail.preimage_count();
 
+		TraceScope scope(trace, OrderTrace::Reducer::degree_two_chain, node_count, arc_count);
+
 		assert(tail.preimage_count() == arc_count);
 		assert(head.preimage_count() == arc_count);
 		assert(arc_weight.preimage_count() == arc_count);
@@ -714,9 +778,6 @@ namespace cch_order{
 		assert(is_loop_free(tail, head));
 
 
-		BitIDFunc keep_flag(arc_count);
-		keep_flag.fill(true);
-
 		auto inv_tail = invert_sorted_id_id_func(tail);
 		auto degree = id_func(
 			node_count, 
@@ -732,77 +793,133 @@ namespace cch_order{
 			}
 		);
 
-		for(auto first_arc=0; first_arc<arc_count; ++first_arc){
-			auto 
-				chain_begin = tail(first_arc),
-				chain_now = head(first_arc);
-
-			if(degree(chain_begin) > 2 && degree(chain_now) <= 2){
-				auto chain_prev = chain_begin;
-				auto chain_weight = arc_weight(first_arc);
-
-				int arc_prev_to_now = first_arc;
-
-				while(degree(chain_now) == 2){
-					for(auto arc_now_to_next : inv_tail(chain_now)){
-						auto chain_next = head(arc_now_to_next);
-						if(chain_next != chain_prev){
-							chain_weight += arc_weight(arc_now_to_next);
-						
-							chain_prev = chain_now;
-							chain_now = chain_next;
-							arc_prev_to_now = arc_now_to_next;
-							break;
-						}
-					}
-				}
+		// Every chain begins with an arc from a core node to a non-core node. Walking a
+		// chain only reads the arcs of non-core nodes, which are never modified, and
+		// contracting it only writes to its first arc and to its last arc or the back
+		// arc of its first arc. Distinct chains therefore touch distinct arcs and are
+		// contracted in parallel. The keep flags are bytes instead of bits, such that
+		// concurrent writes do not interfere.
 
-				assert(arc_prev_to_now != -1);
+		const int grain_size = 1024;
 
-				auto chain_end = chain_now;
-				auto last_arc = arc_prev_to_now;
-				
-				assert(degree(chain_end) != 0);
+		ArrayIDFunc<bool>keep_flag(arc_count);
+		tbb::parallel_for(tbb::blocked_range<int>(0, arc_count, grain_size), [&](const tbb::blocked_range<int>&r){
+			std::fill(keep_flag.begin() + r.begin(), keep_flag.begin() + r.end(), true);
+		});
 
-				if(degree(chain_end) == 1){
-					// Dead end, no shortcut needed
-					keep_flag.set(first_arc, false);
-					for(auto back_arc_for_first_arc:inv_tail(head(first_arc))){
-						if(head(back_arc_for_first_arc) == tail(first_arc)){
-							keep_flag.set(back_arc_for_first_arc, false);
-							break;
+		tbb::parallel_for(tbb::blocked_range<int>(0, arc_count, grain_size), [&](const tbb::blocked_range<int>&r){
+			for(auto first_arc=r.begin(); first_arc!=r.end(); ++first_arc){
+				auto 
+					chain_begin = tail(first_arc),
+					chain_now = head(first_arc);
+
+				if(degree(chain_begin) > 2 && degree(chain_now) <= 2){
+					auto chain_prev = chain_begin;
+					auto chain_weight = arc_weight(first_arc);
+
+					int arc_prev_to_now = first_arc;
+
+					while(degree(chain_now) == 2){
+						for(auto arc_now_to_next : inv_tail(chain_now)){
+							auto chain_next = head(arc_now_to_next);
+							if(chain_next != chain_prev){
+								chain_weight += arc_weight(arc_now_to_next);
+							
+								chain_prev = chain_now;
+								chain_now = chain_next;
+								arc_prev_to_now = arc_now_to_next;
+								break;
+							}
 						}
 					}
-				}else{
-					if(chain_begin == chain_end){
-						// The chain is a loop, no shortcut needed
-						keep_flag.set(first_arc, false);
-						keep_flag.set(last_arc, false);
+
+					assert(arc_prev_to_now != -1);
+
+					auto chain_end = chain_now;
+					auto last_arc = arc_prev_to_now;
+					
+					assert(degree(chain_end) != 0);
+
+					if(degree(chain_end) == 1){
+						// Dead end, no shortcut needed
+						keep_flag[first_arc] = false;
+						for(auto back_arc_for_first_arc:inv_tail(head(first_arc))){
+							if(head(back_arc_for_first_arc) == tail(first_arc)){
+								keep_flag[back_arc_for_first_arc] = false;
+								break;
+							}
+						}
 					}else{
-						// A normal chain, shortcut needed
-						head[first_arc] = chain_end;
-						arc_weight[first_arc] = chain_weight;
-						keep_flag.set(last_arc, false);
+						if(chain_begin == chain_end){
+							// The chain is a loop, no shortcut needed
+							keep_flag[first_arc] = false;
+							keep_flag[last_arc] = false;
+						}else{
+							// A normal chain, shortcut needed
+							head[first_arc] = chain_end;
+							arc_weight[first_arc] = chain_weight;
+							keep_flag[last_arc] = false;
+						}
 					}
 				}
 			}
-		}
+		});
 
-		// Remove arcs between chains and the rest graph
-		{
-			arc_count = count_true(keep_flag);
-			tail = keep_if(keep_flag, arc_count, std::move(tail));
-			head = keep_if(keep_flag, arc_count, std::move(head));
-			arc_weight = keep_if(keep_flag, arc_count, std::move(arc_weight));
-		}
+		// Remove multi arcs. Of several arcs with the same tail and head, the first
+		// one is kept. Only shortcuts create multi-arcs. These leave core nodes, whose
+		// arcs are consecutive, and thus every core node is checked on its own.
+		tbb::parallel_for(tbb::blocked_range<int>(0, node_count, grain_size), [&](const tbb::blocked_range<int>&r){
+			std::vector<std::pair<int, int>>head_and_arc;
+			for(int x=r.begin(); x!=r.end(); ++x){
+				if(!node_in_core(x))
+					continue;
+				head_and_arc.clear();
+				for(auto xy:inv_tail(x))
+					if(keep_flag[xy])
+						head_and_arc.push_back({head(xy), xy});
+				std::sort(head_and_arc.begin(), head_and_arc.end());
+				for(int i=1; i<(int)head_and_arc.size(); ++i)
+					if(head_and_arc[i].first == head_and_arc[i-1].first)
+						keep_flag[head_and_arc[i].second] = false;
+			}
+		});
 
-		// Remove multi arcs
+		// Remove arcs between chains and the rest graph and the multi arcs. The new
+		// arc ids are a parallel prefix sum over the keep flags.
 		{
-			keep_flag = identify_non_multi_arcs(tail, head);
-			arc_count = count_true(keep_flag);
-			tail = keep_if(keep_flag, arc_count, std::move(tail));
-			head = keep_if(keep_flag, arc_count, std::move(head));
-			arc_weight = keep_if(keep_flag, arc_count, std::move(arc_weight));
+			ArrayIDFunc<int>new_arc_id(arc_count);
+			const int new_arc_count = tbb::parallel_scan(
+				tbb::blocked_range<int>(0, arc_count, grain_size), 0,
+				[&](const tbb::blocked_range<int>&r, int sum, bool is_final_scan){
+					for(int xy=r.begin(); xy!=r.end(); ++xy){
+						if(is_final_scan)
+							new_arc_id[xy] = sum;
+						if(keep_flag[xy])
+							++sum;
+					}
+					return sum;
+				},
+				[](int l, int r){
+					return l + r;
+				}
+			);
+
+			ArrayIDIDFunc new_tail(new_arc_count, node_count), new_head(new_arc_count, node_count);
+			ArrayIDFunc<int>new_arc_weight(new_arc_count);
+			tbb::parallel_for(tbb::blocked_range<int>(0, arc_count, grain_size), [&](const tbb::blocked_range<int>&r){
+				for(int xy=r.begin(); xy!=r.end(); ++xy){
+					if(keep_flag[xy]){
+						new_tail[new_arc_id[xy]] = tail(xy);
+						new_head[new_arc_id[xy]] = head(xy);
+						new_arc_weight[new_arc_id[xy]] = arc_weight(xy);
+					}
+				}
+			});
+
+			arc_count = new_arc_count;
+			tail = std::move(new_tail);
+			head = std::move(new_head);
+			arc_weight = std::move(new_arc_weight);
 		}
 
 		#ifndef NDEBUG
@@ -837,18 +954,20 @@ namespace cch_order{
 
 		#endif
 
+		scope.finish();
+
 		#ifdef NDEBUG
 		return reorder_nodes_in_preorder_and_compute_unconnected_graph_order_if_component_is_non_trivial(
 			std::move(tail), std::move(head), 
 			std::move(input_node_id), std::move(arc_weight),
-			compute_core_graph_order, node_in_core
+			compute_core_graph_order, node_in_core, trace
 		);
 		#else
 
 		auto order = reorder_nodes_in_preorder_and_compute_unconnected_graph_order_if_component_is_non_trivial(
 			tail, head, 
 			input_node_id, arc_weight,
-			compute_core_graph_order, node_in_core
+			compute_core_graph_order, node_in_core, trace
 		);
 
 		{
@@ -877,11 +996,14 @@ namespace cch_order{
 	ArrayIDIDFunc compute_graph_order_with_largest_biconnected_component_at_the_end(
 		ArrayIDIDFunc tail, ArrayIDIDFunc head, 
 		ArrayIDIDFunc input_node_id, ArrayIDFunc<int>arc_weight,
-		const ComputeConnectedGraphOrder&compute_component_graph_order
+		const ComputeConnectedGraphOrder&compute_component_graph_order,
+		TraceContext trace = TraceContext()
 	){
 		int node_count = tail.image_count();
 		int arc_count = tail.preimage_count();
 
+		TraceScope scope(trace, OrderTrace::Reducer::biconnected_component, node_count, arc_count);
+
 		// Determine the nodes incident to largest biconnected component.
 		// Large in terms of many arcs.
 
@@ -891,8 +1013,23 @@ namespace cch_order{
 			auto out_arc = invert_sorted_id_id_func(tail);
 			auto back_arc = compute_back_arc_permutation(tail, head);
 
-			auto arc_component = compute_biconnected_components(out_arc, head, back_arc);
-			auto largest_component = max_preimage_over_id_func(compute_histogram(arc_component));
+			// Depth first search is sequential, while the parallel algorithm does
+			// about five times more work on a graph in preorder. It therefore only
+			// pays off on large graphs with many threads. Both number the
+			// components differently, and thus ties are broken by the smallest arc
+			// id, such that the order does not depend on the thread count.
+			const int min_node_count_for_parallel_biconnected_components = 1 << 16;
+			const int min_thread_count_for_parallel_biconnected_components = 8;
+			auto arc_component =
+				node_count >= min_node_count_for_parallel_biconnected_components
+				&& tbb::this_task_arena::max_concurrency() >= min_thread_count_for_parallel_biconnected_components
+				? compute_biconnected_components_in_parallel(out_arc, head, back_arc)
+				: compute_biconnected_components(out_arc, head, back_arc);
+			auto component_size = compute_histogram(arc_component);
+			int largest_component = -1;
+			for(int i=0; i<arc_count; ++i)
+				if(largest_component == -1 || component_size(arc_component(i)) > component_size(largest_component))
+					largest_component = arc_component(i);
 			node_in_largest_biconnected_component.fill(false);
 			for(int i=0; i<arc_count; ++i){
 				if(arc_component(i) == largest_component){
@@ -918,10 +1055,12 @@ namespace cch_order{
 			head = keep_if(keep_flag, arc_count, std::move(head));
 			arc_weight = keep_if(keep_flag, arc_count, std::move(arc_weight));
 		}
+		scope.finish();
+
 		return reorder_nodes_in_preorder_and_compute_unconnected_graph_order_if_component_is_non_trivial(
 			std::move(tail), std::move(head), 
 			std::move(input_node_id), std::move(arc_weight),
-			compute_component_graph_order, std::move(node_in_largest_biconnected_component)
+			compute_component_graph_order, std::move(node_in_largest_biconnected_component), trace
 		);
 	}
 
@@ -940,9 +1079,9 @@ namespace cch_order{
 		// Sort arcs
 		{
 			auto p = sort_arcs_first_by_tail_second_by_head(tail, head);
-			tail = chain(p, std::move(tail));
-			head = chain(p, std::move(head));
-			arc_weight = chain(p, std::move(arc_weight));
+			permute_preimage_in_place(p, tail);
+			permute_preimage_in_place(p, head);
+			permute_preimage_in_place(p, arc_weight);
 		}
 		
 		// Remove multi-arcs and loops (requires sorted arcs)
@@ -1003,33 +1142,207 @@ namespace cch_order{
 		return order; // NVRO
 	}
 
+	// Like compute_nested_dissection_graph_order, but the separators and orders of all
+	// sub-problems with enough nodes are stored in the checkpoint. Separators and orders
+	// that the checkpoint loaded from a previous run are not recomputed.
 	template<class ComputeSeparator>
-	ArrayIDIDFunc compute_cch_graph_order(
-		ArrayIDIDFunc tail, ArrayIDIDFunc head,
+	ArrayIDIDFunc compute_nested_dissection_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head, 
 		ArrayIDIDFunc input_node_id,
 		ArrayIDFunc<int> arc_weight, 
-		const ComputeSeparator&compute_separator
+		const ComputeSeparator&compute_separator,
+		OrderCheckpoint&checkpoint
 	){
+		if(tail.image_count() < checkpoint.get_min_node_count()){
+			return compute_nested_dissection_graph_order(
+				std::move(tail), std::move(head), 
+				std::move(input_node_id), std::move(arc_weight), 
+				compute_separator
+			);
+		}
 
-		make_graph_simple(tail, head, arc_weight);
+		const auto key = compute_sub_problem_key(input_node_id, tail.preimage_count());
 
-		auto orderer4 = [&](
-			ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head,
-			ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int> a_arc_weight
+		ArrayIDIDFunc order;
+		if(checkpoint.find_order(key, input_node_id.image_count(), order))
+			return order;
+
+		auto compute_checkpointed_separator = [&](
+			const ArrayIDIDFunc&a_tail, const ArrayIDIDFunc&a_head, 
+			const ArrayIDIDFunc&a_input_node_id, const ArrayIDFunc<int>&a_arc_weight
+		){
+			std::vector<int>separator;
+			if(!checkpoint.find_separator(key, separator)){
+				separator = compute_separator(a_tail, a_head, a_input_node_id, a_arc_weight);
+				checkpoint.add_separator(key, separator);
+			}
+			return separator;
+		};
+
+		auto compute_graph_part_order = [&](
+			ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head, 
+			ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int>a_arc_weight
 		){
 			return compute_nested_dissection_graph_order(
-				std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
-				compute_separator
+				std::move(a_tail), std::move(a_head), 
+				std::move(a_input_node_id), std::move(a_arc_weight), 
+				compute_separator, checkpoint
+			);
+		};
+
+		order = compute_nested_dissection_graph_order(
+			std::move(tail), std::move(head), 
+			std::move(input_node_id), std::move(arc_weight), 
+			compute_checkpointed_separator, compute_graph_part_order
+		);
+		checkpoint.add_order(key, order);
+		return order; // NVRO
+	}
+
+	// Like compute_nested_dissection_graph_order, but every separator is recorded in
+	// update.new_hierarchy as child of new_parent. The separator of the child of old_parent
+	// in update.old_hierarchy that shares most nodes with the graph is reused instead of
+	// calling compute_separator, if it still splits the graph as well as before: After
+	// removing it, at least two components must remain, no component may be larger than
+	// the largest component was in the old graph plus the number of nodes that the graph
+	// gained, and no component may violate the balance rule of update.max_imbalance. Like
+	// for a fresh cut, the balance rule is soft: If the old separator already violated
+	// it, then the cutter found no balanced cut and the separator may be reused anyway.
+	template<class ComputeSeparator>
+	ArrayIDIDFunc compute_nested_dissection_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head, 
+		ArrayIDIDFunc input_node_id,
+		ArrayIDFunc<int> arc_weight, 
+		const ComputeSeparator&compute_separator,
+		SeparatorHierarchyUpdate&update, int old_parent, int new_parent
+	){
+		const int node_count = tail.image_count();
+		const SeparatorHierarchy&old_hierarchy = update.old_hierarchy;
+
+		const int old_sub_problem = old_hierarchy.find_sub_problem(old_parent, input_node_id);
+		int new_sub_problem = SeparatorHierarchy::no_sub_problem;
+
+		auto compute_reusable_separator = [&](
+			const ArrayIDIDFunc&a_tail, const ArrayIDIDFunc&a_head, 
+			const ArrayIDIDFunc&a_input_node_id, const ArrayIDFunc<int>&a_arc_weight
+		){
+			std::vector<int>separator;
+			int largest_component_node_count = 0;
+
+			if(old_sub_problem != SeparatorHierarchy::no_sub_problem){
+				for(int x=0; x<node_count; ++x)
+					if(old_hierarchy.get_sub_problem_of_separator_node(a_input_node_id(x)) == old_sub_problem)
+						separator.push_back(x);
+				if(!separator.empty()){
+					largest_component_node_count = compute_largest_component_node_count_without_separator(a_tail, a_head, separator);
+					int gained_node_count = std::max(0, node_count - old_hierarchy.get_sub_problem_node_count(old_sub_problem));
+					bool splits_graph = largest_component_node_count < node_count - static_cast<int>(separator.size());
+					bool was_balanced = old_hierarchy.get_largest_component_node_count(old_sub_problem) <= (1.0 - update.max_imbalance) * old_hierarchy.get_sub_problem_node_count(old_sub_problem);
+					if(
+						!splits_graph ||
+						largest_component_node_count > old_hierarchy.get_largest_component_node_count(old_sub_problem) + gained_node_count ||
+						(was_balanced && largest_component_node_count > (1.0 - update.max_imbalance) * node_count)
+					)
+						separator.clear();
+				}
+			}
+
+			if(separator.empty()){
+				separator = compute_separator(a_tail, a_head, a_input_node_id, a_arc_weight);
+				largest_component_node_count = compute_largest_component_node_count_without_separator(a_tail, a_head, separator);
+				++update.computed_separator_count;
+			}else{
+				++update.reused_separator_count;
+			}
+
+			std::vector<int>input_separator(separator.size());
+			for(unsigned i=0; i<separator.size(); ++i)
+				input_separator[i] = a_input_node_id(separator[i]);
+			new_sub_problem = update.new_hierarchy.add_sub_problem(new_parent, std::move(input_separator), node_count, largest_component_node_count);
+
+			return separator;
+		};
+
+		auto compute_graph_part_order = [&](
+			ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head, 
+			ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int>a_arc_weight
+		){
+			assert(new_sub_problem != SeparatorHierarchy::no_sub_problem);
+			return compute_nested_dissection_graph_order(
+				std::move(a_tail), std::move(a_head), 
+				std::move(a_input_node_id), std::move(a_arc_weight), 
+				compute_separator, update, old_sub_problem, new_sub_problem
+			);
+		};
+
+		return compute_nested_dissection_graph_order(
+			std::move(tail), std::move(head), 
+			std::move(input_node_id), std::move(arc_weight), 
+			compute_reusable_separator, compute_graph_part_order
+		);
+	}
+
+	// Like compute_nested_dissection_graph_order, but every separator computation and every
+	// trivial part is recorded in the trace at the depth of its sub-problem.
+	// compute_separator must accept a SeparatorTrace as fifth parameter, which it fills
+	// with the work of its cutters.
+	template<class ComputeSeparator>
+	ArrayIDIDFunc compute_nested_dissection_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head, 
+		ArrayIDIDFunc input_node_id,
+		ArrayIDFunc<int> arc_weight, 
+		const ComputeSeparator&compute_separator,
+		TraceContext trace
+	){
+		auto compute_traced_separator = [&](
+			const ArrayIDIDFunc&a_tail, const ArrayIDIDFunc&a_head, 
+			const ArrayIDIDFunc&a_input_node_id, const ArrayIDFunc<int>&a_arc_weight
+		){
+			TraceScope scope(trace, OrderTrace::Reducer::separator, a_tail.image_count(), a_tail.preimage_count());
+			auto separator = compute_separator(a_tail, a_head, a_input_node_id, a_arc_weight, scope.get_separator_trace());
+			scope.set_separator_node_count(separator.size());
+			scope.finish();
+			return separator;
+		};
+
+		auto compute_graph_part_order = [&](
+			ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head, 
+			ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int>a_arc_weight
+		){
+			return compute_nested_dissection_graph_order(
+				std::move(a_tail), std::move(a_head), 
+				std::move(a_input_node_id), std::move(a_arc_weight), 
+				compute_separator, trace.deeper()
 			);
 		};
 
+		return compute_nested_dissection_graph_order(
+			std::move(tail), std::move(head), 
+			std::move(input_node_id), std::move(arc_weight), 
+			compute_traced_separator, compute_graph_part_order, trace.deeper()
+		);
+	}
+
+	// Removes the largest biconnected component and the degree two chains and orders the
+	// remaining core graphs using compute_core_graph_order.
+	template<class ComputeCoreGraphOrder>
+	ArrayIDIDFunc compute_cch_graph_order_with_core_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head,
+		ArrayIDIDFunc input_node_id,
+		ArrayIDFunc<int> arc_weight, 
+		const ComputeCoreGraphOrder&compute_core_graph_order,
+		TraceContext trace = TraceContext()
+	){
+
+		make_graph_simple(tail, head, arc_weight);
+
 		/*auto orderer3 = [&](
 			ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head,
 			ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int> a_arc_weight
 		){
 			return compute_graph_order_with_large_degree_three_independent_set_at_the_begin(
 				std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
-				orderer4
+				compute_core_graph_order
 			);
 		};*/
 
@@ -1040,7 +1353,7 @@ namespace cch_order{
 		){
 			return compute_graph_order_with_degree_two_chain_at_the_begin(
 				std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
-				orderer4
+				compute_core_graph_order, trace
 			);
 		};
 
@@ -1050,13 +1363,13 @@ namespace cch_order{
 		){
 			return compute_graph_order_with_largest_biconnected_component_at_the_end(
 				std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
-				orderer2
+				orderer2, trace
 			);
 		};
 
 		auto order = reorder_nodes_in_preorder_and_compute_unconnected_graph_order_if_component_is_non_trivial(
 			tail, head, input_node_id, arc_weight, 
-			orderer1, [](int){return false;}
+			orderer1, [](int){return false;}, trace
 		);
 
 		assert(is_permutation(order));
@@ -1064,6 +1377,71 @@ namespace cch_order{
 		return order; // NVRO
 	}
 
+	template<class ComputeSeparator>
+	ArrayIDIDFunc compute_cch_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head,
+		ArrayIDIDFunc input_node_id,
+		ArrayIDFunc<int> arc_weight, 
+		const ComputeSeparator&compute_separator
+	){
+		return compute_cch_graph_order_with_core_graph_order(
+			std::move(tail), std::move(head), std::move(input_node_id), std::move(arc_weight),
+			[&](
+				ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head,
+				ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int> a_arc_weight
+			){
+				return compute_nested_dissection_graph_order(
+					std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
+					compute_separator
+				);
+			}
+		);
+	}
+
+	template<class ComputeSeparator>
+	ArrayIDIDFunc compute_cch_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head,
+		ArrayIDFunc<int> arc_weight, 
+		const ComputeSeparator&compute_separator,
+		OrderCheckpoint&checkpoint
+	){
+		const int node_count = tail.image_count();
+		return compute_cch_graph_order_with_core_graph_order(
+			std::move(tail), std::move(head), identity_permutation(node_count), std::move(arc_weight),
+			[&](
+				ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head,
+				ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int> a_arc_weight
+			){
+				return compute_nested_dissection_graph_order(
+					std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
+					compute_separator, checkpoint
+				);
+			}
+		);
+	}
+
+	template<class ComputeSeparator>
+	ArrayIDIDFunc compute_cch_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head,
+		ArrayIDFunc<int> arc_weight, 
+		const ComputeSeparator&compute_separator,
+		SeparatorHierarchyUpdate&update
+	){
+		const int node_count = tail.image_count();
+		return compute_cch_graph_order_with_core_graph_order(
+			std::move(tail), std::move(head), identity_permutation(node_count), std::move(arc_weight),
+			[&](
+				ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head,
+				ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int> a_arc_weight
+			){
+				return compute_nested_dissection_graph_order(
+					std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
+					compute_separator, update, SeparatorHierarchy::no_parent, SeparatorHierarchy::no_parent
+				);
+			}
+		);
+	}
+
 	template<class ComputeSeparator>
 	ArrayIDIDFunc compute_cch_graph_order(
 		ArrayIDIDFunc tail, ArrayIDIDFunc head,
@@ -1073,6 +1451,29 @@ namespace cch_order{
 		return compute_cch_graph_order(std::move(tail), std::move(head), identity_permutation(tail.image_count()), std::move(arc_weight), compute_separator);
 	}
 
+	template<class ComputeSeparator>
+	ArrayIDIDFunc compute_cch_graph_order(
+		ArrayIDIDFunc tail, ArrayIDIDFunc head,
+		ArrayIDFunc<int> arc_weight, 
+		const ComputeSeparator&compute_separator,
+		OrderTrace&trace
+	){
+		const int node_count = tail.image_count();
+		return compute_cch_graph_order_with_core_graph_order(
+			std::move(tail), std::move(head), identity_permutation(node_count), std::move(arc_weight),
+			[&](
+				ArrayIDIDFunc a_tail, ArrayIDIDFunc a_head,
+				ArrayIDIDFunc a_input_node_id, ArrayIDFunc<int> a_arc_weight
+			){
+				return compute_nested_dissection_graph_order(
+					std::move(a_tail), std::move(a_head), std::move(a_input_node_id), std::move(a_arc_weight), 
+					compute_separator, TraceContext{&trace, 0}
+				);
+			},
+			TraceContext{&trace, 0}
+		);
+	}
+
 	class ComputeConstantSeparator{
 	public:
 		explicit ComputeConstantSeparator(std::vector<int>sep):sep(std::move(sep)){}
@@ -3,6 +3,9 @@
 
 #include "flow_cutter.h"
 #include "flow_cutter_accelerated.h"
+#include "id_multi_func.h"
+
+#include <cassert>
 
 namespace flow_cutter{
 
@@ -241,6 +244,82 @@ namespace flow_cutter{
 			};
 		}
 
+		//! Same as make_graph but the expanded graph is stored explicitly as CSR.
+		//! The arc IDs are the same as in the virtual expanded graph and the
+		//! outgoing arcs of every expanded node are enumerated in the same order,
+		//! i.e., the intra arc first and then the inter arcs. Therefore, both
+		//! variants produce identical cuts. The capacity is not materialized as it
+		//! is a function of the arc ID only.
+		template<class Tail, class Head, class BackArc, class ArcWeight, class OutArc>
+		Graph<
+			ArrayIDIDFunc,
+			ArrayIDIDFunc,
+			ArrayIDIDFunc,
+			ArrayIDFunc<int>,
+			expanded_graph::Capacity,
+			ArrayIDIDMultiFunc
+		>
+		make_materialized_graph(const Tail&tail, const Head&head, const BackArc&back_arc, const ArcWeight&arc_weight, const OutArc&out_arc){
+			const int node_count = tail.image_count(), arc_count = tail.preimage_count();
+			const int expanded_nodes = expanded_node_count(node_count), expanded_arcs = expanded_arc_count(node_count, arc_count);
+
+			ArrayIDIDFunc expanded_tail(expanded_arcs, expanded_nodes);
+			ArrayIDIDFunc expanded_head(expanded_arcs, expanded_nodes);
+			ArrayIDIDFunc expanded_back_arc(expanded_arcs, expanded_arcs);
+			ArrayIDFunc<int> expanded_arc_weight(expanded_arcs);
+
+			for(int a=0; a<arc_count; ++a){
+				for(bool out_flag : {false, true}){
+					int xy = original_arc_to_expanded_inter_arc(a, out_flag, arc_count);
+					expanded_tail[xy] = original_node_to_expanded_node(tail(a), out_flag);
+					expanded_head[xy] = original_node_to_expanded_node(head(a), !out_flag);
+					expanded_back_arc[xy] = original_arc_to_expanded_inter_arc(back_arc(a), !out_flag, arc_count);
+					expanded_arc_weight[xy] = arc_weight(a);
+				}
+			}
+
+			for(int x=0; x<node_count; ++x){
+				for(bool out_flag : {false, true}){
+					int xx = original_node_to_expanded_intra_arc(x, out_flag, arc_count);
+					expanded_tail[xx] = original_node_to_expanded_node(x, out_flag);
+					expanded_head[xx] = original_node_to_expanded_node(x, !out_flag);
+					expanded_back_arc[xx] = original_node_to_expanded_intra_arc(x, !out_flag, arc_count);
+					expanded_arc_weight[xx] = 0;
+				}
+			}
+
+			ArrayIDIDMultiFunc expanded_out_arc = {
+				RangeIDIDMultiFunc{
+					ArrayIDFunc<int>{expanded_nodes+1}
+				},
+				ArrayIDIDFunc{expanded_arcs, expanded_arcs}
+			};
+
+			auto&begin = expanded_out_arc.preimage_to_intermediate.range_begin;
+			auto&arc_list = expanded_out_arc.intermediate_to_image;
+
+			int pos = 0;
+			for(int x=0; x<node_count; ++x){
+				for(bool out_flag : {false, true}){
+					begin[original_node_to_expanded_node(x, out_flag)] = pos;
+					arc_list[pos++] = original_node_to_expanded_intra_arc(x, out_flag, arc_count);
+					for(auto a : out_arc(x))
+						arc_list[pos++] = original_arc_to_expanded_inter_arc(a, out_flag, arc_count);
+				}
+			}
+			begin[expanded_nodes] = pos;
+			assert(pos == expanded_arcs);
+
+			return {
+				std::move(expanded_tail),
+				std::move(expanded_head),
+				std::move(expanded_back_arc),
+				std::move(expanded_arc_weight),
+				expanded_graph::capacity(node_count, arc_count),
+				std::move(expanded_out_arc)
+			};
+		}
+
 		struct MixedCut{
 			std::vector<int>arcs, nodes;
 		};
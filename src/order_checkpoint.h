@@ -0,0 +1,337 @@
+#ifndef ORDER_CHECKPOINT_H
+#define ORDER_CHECKPOINT_H
+
+#include "array_id_func.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+
+namespace cch_order{
+
+	//! 64-bit FNV-1a over 32-bit words. Used to fingerprint graphs and sub-problems.
+	class Hasher{
+	public:
+		Hasher():h(14695981039346656037ull){}
+
+		void add(std::uint32_t x){
+			for(int i=0; i<4; ++i){
+				h ^= (x >> (8*i)) & 0xFF;
+				h *= 1099511628211ull;
+			}
+		}
+
+		void add(int x){
+			add(static_cast<std::uint32_t>(x));
+		}
+
+		void add(double x){
+			std::uint64_t y;
+			std::memcpy(&y, &x, sizeof(y));
+			add(static_cast<std::uint32_t>(y));
+			add(static_cast<std::uint32_t>(y >> 32));
+		}
+
+		void add(const std::string&str){
+			add(static_cast<int>(str.size()));
+			for(char c:str)
+				add(static_cast<int>(c));
+		}
+
+		template<class IDFunc>
+		void add_id_func(const IDFunc&f){
+			add(f.preimage_count());
+			for(int i=0; i<f.preimage_count(); ++i)
+				add(f(i));
+		}
+
+		std::uint64_t get()const{
+			return h;
+		}
+
+	private:
+		std::uint64_t h;
+	};
+
+	//! Identifies a sub-problem of the nested dissection recursion by its nodes, in
+	//! the order in which they are numbered in the sub-problem, and its arc count.
+	struct SubProblemKey{
+		std::uint64_t hash;
+		int node_count, arc_count;
+
+		bool operator==(const SubProblemKey&o)const{
+			return hash == o.hash && node_count == o.node_count && arc_count == o.arc_count;
+		}
+	};
+
+	template<class InputNodeID>
+	SubProblemKey compute_sub_problem_key(const InputNodeID&input_node_id, int arc_count){
+		Hasher h;
+		h.add_id_func(input_node_id);
+		h.add(arc_count);
+		return {h.get(), input_node_id.preimage_count(), arc_count};
+	}
+
+	struct SubProblemKeyHash{
+		std::size_t operator()(const SubProblemKey&key)const{
+			return static_cast<std::size_t>(key.hash);
+		}
+	};
+
+	//! Stores the separators and the orders of the sub-problems of a nested dissection
+	//! order computation in a file, such that a killed computation can be resumed.
+	//!
+	//! The file consists of a header followed by a sequence of records. New records
+	//! are queued by the worker threads and appended by a background thread every
+	//! write_interval, so that the workers never wait for the disk. A record that was
+	//! only partially written when the process died is ignored when resuming.
+	//!
+	//! The recursion is deterministic. Therefore the pending sub-problems need not be
+	//! stored: A resumed computation recomputes them, but takes the separator or the
+	//! order of every sub-problem that was already stored from the file.
+	class OrderCheckpoint{
+	public:
+		//! If resume is false, then the file is replaced. Otherwise the records in the
+		//! file are loaded. The file must belong to a graph and a configuration with the
+		//! same fingerprint. Only sub-problems with at least min_node_count nodes are stored.
+		OrderCheckpoint(
+			const std::string&file_name, std::uint64_t fingerprint, bool resume,
+			int min_node_count = 1000,
+			std::chrono::milliseconds write_interval = std::chrono::seconds(10)
+		):
+			file_name(file_name), min_node_count(min_node_count),
+			write_interval(write_interval), write_failed(false), stop_requested(false)
+		{
+			if(resume)
+				load(fingerprint);
+
+			// The loaded records are rewritten without a partially written last record.
+			// This happens in a temporary file that then replaces the checkpoint, such
+			// that a crash in between does not lose the stored progress.
+			std::string tmp_file_name = file_name + ".tmp";
+			out.open(tmp_file_name, std::ios::binary | std::ios::trunc);
+			if(!out)
+				throw std::runtime_error("Can not open \""+tmp_file_name+"\" for writing.");
+			write_header(fingerprint);
+			for(auto&r:loaded_separator)
+				write_record(SeparatorRecord, r.first, r.second);
+			for(auto&r:loaded_order)
+				write_record(OrderRecord, r.first, r.second);
+			out.close();
+			if(!out)
+				throw std::runtime_error("Can not write to \""+tmp_file_name+"\".");
+			if(std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0)
+				throw std::runtime_error("Can not replace \""+file_name+"\" by \""+tmp_file_name+"\".");
+
+			out.open(file_name, std::ios::binary | std::ios::app);
+			if(!out)
+				throw std::runtime_error("Can not open \""+file_name+"\" for writing.");
+
+			writer = std::thread([this]{write_loop();});
+		}
+
+		OrderCheckpoint(const OrderCheckpoint&) = delete;
+		OrderCheckpoint&operator=(const OrderCheckpoint&) = delete;
+
+		~OrderCheckpoint(){
+			stop_writer();
+		}
+
+		//! Writes all queued records and throws if the file could not be written.
+		void finish(){
+			stop_writer();
+			if(write_failed)
+				throw std::runtime_error("Can not write to \""+file_name+"\".");
+		}
+
+		int get_min_node_count()const{
+			return min_node_count;
+		}
+
+		int get_loaded_separator_count()const{
+			return loaded_separator.size();
+		}
+
+		int get_loaded_order_count()const{
+			return loaded_order.size();
+		}
+
+		//! The lookups only consider the loaded records and may therefore be called
+		//! concurrently with each other and with the add functions.
+		bool find_separator(const SubProblemKey&key, std::vector<int>&separator)const{
+			auto iter = loaded_separator.find(key);
+			if(iter == loaded_separator.end())
+				return false;
+			separator = iter->second;
+			return true;
+		}
+
+		bool find_order(const SubProblemKey&key, int input_node_count, ArrayIDIDFunc&order)const{
+			auto iter = loaded_order.find(key);
+			if(iter == loaded_order.end())
+				return false;
+			order = ArrayIDIDFunc(static_cast<int>(iter->second.size()), input_node_count);
+			for(int i=0; i<order.preimage_count(); ++i){
+				if(iter->second[i] < 0 || iter->second[i] >= input_node_count)
+					throw std::runtime_error("Checkpoint file \""+file_name+"\" is corrupt.");
+				order[i] = iter->second[i];
+			}
+			return true;
+		}
+
+		void add_separator(const SubProblemKey&key, std::vector<int>separator){
+			enqueue(SeparatorRecord, key, std::move(separator));
+		}
+
+		void add_order(const SubProblemKey&key, const ArrayIDIDFunc&order){
+			enqueue(OrderRecord, key, std::vector<int>(order.begin(), order.end()));
+		}
+
+	private:
+		static const char*get_magic(){
+			return "IFCCHKP1";
+		}
+		static constexpr int MagicSize = 8;
+		static constexpr int SeparatorRecord = 1;
+		static constexpr int OrderRecord = 2;
+
+		struct Record{
+			int type;
+			SubProblemKey key;
+			std::vector<int>data;
+		};
+
+		typedef std::unordered_map<SubProblemKey, std::vector<int>, SubProblemKeyHash> RecordMap;
+
+		template<class T>
+		void write_value(const T&x){
+			out.write(reinterpret_cast<const char*>(&x), sizeof(x));
+		}
+
+		template<class T>
+		static bool read_value(std::istream&in, T&x){
+			in.read(reinterpret_cast<char*>(&x), sizeof(x));
+			return static_cast<bool>(in);
+		}
+
+		void write_header(std::uint64_t fingerprint){
+			out.write(get_magic(), MagicSize);
+			write_value(fingerprint);
+		}
+
+		void write_record(int type, const SubProblemKey&key, const std::vector<int>&data){
+			write_value(type);
+			write_value(key.hash);
+			write_value(key.node_count);
+			write_value(key.arc_count);
+			write_value(static_cast<int>(data.size()));
+			out.write(reinterpret_cast<const char*>(data.data()), data.size()*sizeof(int));
+		}
+
+		void load(std::uint64_t fingerprint){
+			std::ifstream in(file_name, std::ios::binary);
+			if(!in)
+				throw std::runtime_error("Can not open \""+file_name+"\" for reading.");
+
+			char file_magic[MagicSize];
+			std::uint64_t file_fingerprint;
+			in.read(file_magic, sizeof(file_magic));
+			if(!in || std::memcmp(file_magic, get_magic(), MagicSize) != 0)
+				throw std::runtime_error("\""+file_name+"\" is no order checkpoint file.");
+			if(!read_value(in, file_fingerprint) || file_fingerprint != fingerprint)
+				throw std::runtime_error("Checkpoint file \""+file_name+"\" was written for another graph or another configuration.");
+
+			for(;;){
+				int type, size;
+				SubProblemKey key;
+				if(!read_value(in, type) || !read_value(in, key.hash) || !read_value(in, key.node_count) || !read_value(in, key.arc_count) || !read_value(in, size))
+					break;
+				if((type != SeparatorRecord && type != OrderRecord) || size < 0 || size > key.node_count)
+					throw std::runtime_error("Checkpoint file \""+file_name+"\" is corrupt.");
+				std::vector<int>data(size);
+				in.read(reinterpret_cast<char*>(data.data()), size*sizeof(int));
+				if(!in)
+					break;
+				if(type == SeparatorRecord){
+					for(int x:data)
+						if(x < 0 || x >= key.node_count)
+							throw std::runtime_error("Checkpoint file \""+file_name+"\" is corrupt.");
+					loaded_separator[key] = std::move(data);
+				}else{
+					if(size != key.node_count)
+						throw std::runtime_error("Checkpoint file \""+file_name+"\" is corrupt.");
+					loaded_order[key] = std::move(data);
+				}
+			}
+		}
+
+		void enqueue(int type, const SubProblemKey&key, std::vector<int>data){
+			std::lock_guard<std::mutex>lock(queue_lock);
+			queue.push_back({type, key, std::move(data)});
+		}
+
+		void write_queued_records(){
+			std::vector<Record>to_write;
+			{
+				std::lock_guard<std::mutex>lock(queue_lock);
+				to_write.swap(queue);
+			}
+			if(to_write.empty() || write_failed)
+				return;
+			for(auto&r:to_write)
+				write_record(r.type, r.key, r.data);
+			out.flush();
+			if(!out)
+				write_failed = true;
+		}
+
+		void write_loop(){
+			std::unique_lock<std::mutex>lock(stop_lock);
+			while(!stop_requested){
+				stop_condition.wait_for(lock, write_interval);
+				lock.unlock();
+				write_queued_records();
+				lock.lock();
+			}
+		}
+
+		void stop_writer(){
+			if(!writer.joinable())
+				return;
+			{
+				std::lock_guard<std::mutex>lock(stop_lock);
+				stop_requested = true;
+			}
+			stop_condition.notify_one();
+			writer.join();
+			write_queued_records();
+		}
+
+		std::string file_name;
+		int min_node_count;
+		std::chrono::milliseconds write_interval;
+
+		RecordMap loaded_separator, loaded_order;
+
+		std::ofstream out;
+		bool write_failed;
+
+		std::mutex queue_lock;
+		std::vector<Record>queue;
+
+		std::mutex stop_lock;
+		std::condition_variable stop_condition;
+		bool stop_requested;
+		std::thread writer;
+	};
+}
+
+#endif
@@ -0,0 +1,280 @@
+#ifndef ORDER_TRACE_H
+#define ORDER_TRACE_H
+
+#include "timer.h"
+#include "cutter_statistics.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <stdexcept>
+#include <fstream>
+#include <ostream>
+#include <algorithm>
+#include <set>
+#include <tbb/task_arena.h>
+
+namespace cch_order{
+
+	//! The work of the cutters of a separator computation and how busy the threads were
+	//! while they were enumerated.
+	struct SeparatorTrace{
+		std::vector<flow_cutter_accelerated::CutterStatistics>cutter;
+		flow_cutter_accelerated::CutterSchedulerStatistics scheduler;
+	};
+
+	//! Records which reduction handled the sub-problems of a CCH order computation,
+	//! how deep in the nested dissection recursion they are, which thread handled
+	//! them and how long it took. Every sub-problem is counted in a per-depth summary.
+	//! Sub-problems with at least min_event_node_count nodes are additionally stored
+	//! as events, which save_chrome_trace writes in the Chrome trace event format.
+	//! It can be viewed with chrome://tracing or Perfetto.
+	//!
+	//! The time of an event only covers the work of the reduction itself, not the
+	//! work on the sub-problems that it creates. Separator events also carry the idle
+	//! time of the threads that enumerated the cutters, which is additionally written
+	//! as the counter cutter_idle_time.
+	class OrderTrace{
+	public:
+		enum class Reducer{
+			biconnected_component,
+			degree_two_chain,
+			trivial,
+			separator
+		};
+		static constexpr int reducer_count = 4;
+
+		//! The thread of events that ran outside of a TBB task arena, which has no
+		//! thread index of its own. This is the thread that started the computation.
+		static constexpr int main_thread = -1;
+
+		static const char*get_reducer_name(Reducer r){
+			switch(r){
+			case Reducer::biconnected_component: return "biconnected_component";
+			case Reducer::degree_two_chain: return "degree_two_chain";
+			case Reducer::trivial: return "trivial";
+			case Reducer::separator: return "separator";
+			}
+			return "unknown";
+		}
+
+		struct Event{
+			Reducer reducer;
+			int depth;
+			int thread;
+			int node_count, arc_count;
+			int separator_node_count;
+			long long begin_time, running_time;
+			SeparatorTrace separator;
+		};
+
+		struct LevelSummary{
+			long long sub_problem_count[reducer_count] = {};
+			long long node_count[reducer_count] = {};
+			long long running_time[reducer_count] = {};
+			long long cutter_idle_time[reducer_count] = {};
+		};
+
+		explicit OrderTrace(int min_event_node_count = 0):
+			min_event_node_count(min_event_node_count), begin_time(get_micro_time()){}
+
+		OrderTrace(const OrderTrace&) = delete;
+		OrderTrace&operator=(const OrderTrace&) = delete;
+
+		//! May be called concurrently.
+		void add_event(Event e){
+			std::lock_guard<std::mutex>lock(event_lock);
+			if((int)level.size() <= e.depth)
+				level.resize(e.depth+1);
+			auto&l = level[e.depth];
+			int r = static_cast<int>(e.reducer);
+			++l.sub_problem_count[r];
+			l.node_count[r] += e.node_count;
+			l.running_time[r] += e.running_time;
+			l.cutter_idle_time[r] += e.separator.scheduler.total_idle_time;
+			if(e.node_count >= min_event_node_count)
+				event.push_back(std::move(e));
+		}
+
+		long long get_begin_time()const{
+			return begin_time;
+		}
+
+		const std::vector<Event>&get_events()const{
+			return event;
+		}
+
+		const std::vector<LevelSummary>&get_level_summary()const{
+			return level;
+		}
+
+		//! Prints one line per depth and reduction with the number of sub-problems, their
+		//! total node count, the total time and the total idle time of the threads that
+		//! enumerated the cutters in microseconds.
+		void print_level_summary(std::ostream&out)const{
+			out << "depth,reducer,sub_problem_count,node_count,running_time,cutter_idle_time\n";
+			for(int d=0; d<(int)level.size(); ++d)
+				for(int r=0; r<reducer_count; ++r)
+					if(level[d].sub_problem_count[r] != 0)
+						out << d << ',' << get_reducer_name(static_cast<Reducer>(r)) << ',' << level[d].sub_problem_count[r] << ',' << level[d].node_count[r] << ',' << level[d].running_time[r] << ',' << level[d].cutter_idle_time[r] << '\n';
+		}
+
+		void save_chrome_trace(const std::string&file_name)const{
+			std::ofstream out(file_name);
+			if(!out)
+				throw std::runtime_error("Can not open \""+file_name+"\" for writing.");
+
+			out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			std::set<int>used_thread;
+			bool first = true;
+			for(auto&e:event){
+				if(!first)
+					out << ",\n";
+				first = false;
+				used_thread.insert(e.thread);
+				write_event(out, e);
+				if(e.separator.scheduler.thread_count != 0){
+					out << ",\n";
+					write_idle_time_counter(out, e);
+				}
+			}
+			for(int t:used_thread){
+				if(!first)
+					out << ",\n";
+				first = false;
+				out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << t << ",\"args\":{\"name\":\"";
+				if(t == main_thread)
+					out << "main thread";
+				else
+					out << "thread " << t;
+				out << "\"}}";
+			}
+			out << "\n],\"levels\":[\n";
+			for(int d=0; d<(int)level.size(); ++d){
+				if(d != 0)
+					out << ",\n";
+				out << "{\"depth\":" << d;
+				for(int r=0; r<reducer_count; ++r)
+					out << ",\"" << get_reducer_name(static_cast<Reducer>(r)) << "\":{"
+						<< "\"sub_problem_count\":" << level[d].sub_problem_count[r]
+						<< ",\"node_count\":" << level[d].node_count[r]
+						<< ",\"running_time\":" << level[d].running_time[r]
+						<< ",\"cutter_idle_time\":" << level[d].cutter_idle_time[r] << '}';
+				out << '}';
+			}
+			out << "\n]}\n";
+
+			if(!out)
+				throw std::runtime_error("Can not write to \""+file_name+"\".");
+		}
+
+	private:
+		template<class GetValue>
+		static void write_cutter_array(std::ostream&out, const char*name, const std::vector<flow_cutter_accelerated::CutterStatistics>&cutter, const GetValue&get_value){
+			out << ",\"" << name << "\":[";
+			for(unsigned i=0; i<cutter.size(); ++i){
+				if(i != 0)
+					out << ',';
+				out << get_value(cutter[i]);
+			}
+			out << ']';
+		}
+
+		void write_event(std::ostream&out, const Event&e)const{
+			out << "{\"name\":\"" << get_reducer_name(e.reducer) << "\",\"cat\":\"order\",\"ph\":\"X\""
+				<< ",\"ts\":" << e.begin_time - begin_time << ",\"dur\":" << e.running_time
+				<< ",\"pid\":0,\"tid\":" << e.thread
+				<< ",\"args\":{\"depth\":" << e.depth << ",\"node_count\":" << e.node_count << ",\"arc_count\":" << e.arc_count;
+			if(e.reducer == Reducer::separator){
+				out << ",\"separator_node_count\":" << e.separator_node_count;
+				long long distance_time = 0, flow_time = 0;
+				for(auto&c:e.separator.cutter){
+					distance_time += c.distance_time;
+					flow_time += c.flow_time;
+				}
+				out << ",\"distance_time\":" << distance_time << ",\"flow_time\":" << flow_time;
+				auto&scheduler = e.separator.scheduler;
+				if(scheduler.thread_count != 0)
+					out << ",\"scheduler_thread_count\":" << scheduler.thread_count
+						<< ",\"enumeration_time\":" << scheduler.running_time
+						<< ",\"total_idle_time\":" << scheduler.total_idle_time
+						<< ",\"max_idle_time\":" << scheduler.max_idle_time;
+				write_cutter_array(out, "augmentation_count", e.separator.cutter, [](const flow_cutter_accelerated::CutterStatistics&c){return c.augmentation_count;});
+				write_cutter_array(out, "pierce_count", e.separator.cutter, [](const flow_cutter_accelerated::CutterStatistics&c){return c.pierce_count;});
+				write_cutter_array(out, "bulk_pierce_count", e.separator.cutter, [](const flow_cutter_accelerated::CutterStatistics&c){return c.bulk_pierce_count;});
+				write_cutter_array(out, "cutter_distance_time", e.separator.cutter, [](const flow_cutter_accelerated::CutterStatistics&c){return c.distance_time;});
+				write_cutter_array(out, "cutter_flow_time", e.separator.cutter, [](const flow_cutter_accelerated::CutterStatistics&c){return c.flow_time;});
+			}
+			out << "}}";
+		}
+
+		//! The idle time is known when the enumeration ends, which is at the latest when
+		//! the separator event ends.
+		void write_idle_time_counter(std::ostream&out, const Event&e)const{
+			out << "{\"name\":\"cutter_idle_time\",\"ph\":\"C\",\"ts\":" << e.begin_time + e.running_time - begin_time
+				<< ",\"pid\":0,\"args\":{\"total\":" << e.separator.scheduler.total_idle_time
+				<< ",\"max\":" << e.separator.scheduler.max_idle_time << "}}";
+		}
+
+		int min_event_node_count;
+		long long begin_time;
+
+		std::mutex event_lock;
+		std::vector<Event>event;
+		std::vector<LevelSummary>level;
+	};
+
+	//! The trace and the recursion depth of a sub-problem. The default constructed
+	//! context records nothing, such that the untraced order computation does not
+	//! pay for the tracing.
+	struct TraceContext{
+		OrderTrace*trace = nullptr;
+		int depth = 0;
+
+		TraceContext deeper()const{
+			return {trace, depth+1};
+		}
+	};
+
+	//! Measures the work of a reduction on a sub-problem. finish adds the event to the
+	//! trace of the context, if there is one.
+	class TraceScope{
+	public:
+		TraceScope(TraceContext context, OrderTrace::Reducer reducer, int node_count, int arc_count):trace(context.trace){
+			if(trace != nullptr){
+				e.reducer = reducer;
+				e.depth = context.depth;
+				// Outside of an arena, TBB reports a negative index.
+				e.thread = tbb::this_task_arena::current_thread_index();
+				if(e.thread < 0)
+					e.thread = OrderTrace::main_thread;
+				e.node_count = node_count;
+				e.arc_count = arc_count;
+				e.separator_node_count = 0;
+				e.begin_time = get_micro_time();
+				e.running_time = 0;
+			}
+		}
+
+		SeparatorTrace&get_separator_trace(){
+			return e.separator;
+		}
+
+		void set_separator_node_count(int n){
+			e.separator_node_count = n;
+		}
+
+		void finish(){
+			if(trace != nullptr){
+				e.running_time = get_micro_time() - e.begin_time;
+				trace->add_event(std::move(e));
+				trace = nullptr;
+			}
+		}
+
+	private:
+		OrderTrace*trace;
+		OrderTrace::Event e;
+	};
+}
+
+#endif
@@ -26,6 +26,34 @@ bool is_permutation(const IDIDFunc&f){
 
 
 
+// Does the same as f = chain(p, std::move(f)), i.e., afterwards f(i) is the old f(p(i)),
+// but follows the cycles of p instead of allocating a new array for f.
+template<class IDIDFunc, class T>
+void permute_preimage_in_place(const IDIDFunc&p, ArrayIDFunc<T>&f){
+	assert(is_permutation(p));
+	assert(p.preimage_count() == f.preimage_count());
+
+	int id_count = p.preimage_count();
+
+	BitIDFunc done(id_count);
+	done.fill(false);
+	for(int i=0; i<id_count; ++i){
+		if(!done(i)){
+			T first = f.move(i);
+			int x = i;
+			for(;;){
+				done.set(x, true);
+				int y = p(x);
+				if(y == i)
+					break;
+				f[x] = f.move(y);
+				x = y;
+			}
+			f[x] = std::move(first);
+		}
+	}
+}
+
 template<class IDIDFunc>
 ArrayIDIDFunc inverse_permutation(const IDIDFunc&f){
 	assert(is_permutation(f));
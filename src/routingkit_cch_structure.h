@@ -0,0 +1,186 @@
+#ifndef ROUTINGKIT_CCH_STRUCTURE_H
+#define ROUTINGKIT_CCH_STRUCTURE_H
+
+#include "cch_structure.h"
+#include <routingkit/customizable_contraction_hierarchy.h>
+#include <routingkit/inverse_vector.h>
+#include <routingkit/bit_vector.h>
+#include <routingkit/constants.h>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+//! Builds a RoutingKit CCH from a CCH structure file written by the console command
+//! save_cch_structure, instead of contracting the graph. Only the mapping of the
+//! input arcs onto the upward arcs is computed, which needs a binary search per
+//! input arc. The order must be the one that the structure was computed with and
+//! the input graph must be the one of the console, up to back arcs, multi-arcs,
+//! and loops.
+inline RoutingKit::CustomizableContractionHierarchy load_routingkit_cch_structure(
+	const std::string&file_name,
+	const std::vector<unsigned>&order,
+	const std::vector<unsigned>&tail, const std::vector<unsigned>&head
+){
+	CCHStructure s = load_cch_structure(file_name, false);
+
+	const unsigned node_count = s.node_count();
+	const unsigned cch_arc_count = s.arc_count();
+	const unsigned input_arc_count = tail.size();
+
+	if(order != s.order)
+		throw std::runtime_error("The order does not match the one of \""+file_name+"\"");
+
+	RoutingKit::CustomizableContractionHierarchy cch;
+
+	cch.order = order;
+	cch.rank.resize(node_count);
+	for(unsigned r=0; r<node_count; ++r)
+		cch.rank[order[r]] = r;
+
+	cch.up_first_out = std::move(s.first_out);
+	cch.up_head = std::move(s.head);
+	cch.up_tail = RoutingKit::invert_inverse_vector(cch.up_first_out);
+	cch.elimination_tree_parent = std::move(s.elimination_tree_parent);
+	for(auto&p:cch.elimination_tree_parent)
+		if(p == CCHStructure::invalid_id)
+			p = RoutingKit::invalid_id;
+
+	// The downward arcs are the upward arcs grouped by head. Within a group, they are
+	// increasing by tail, as the upward arcs are increasing by tail.
+	cch.down_first_out.assign(node_count+1, 0);
+	for(unsigned xy=0; xy<cch_arc_count; ++xy)
+		++cch.down_first_out[cch.up_head[xy]+1];
+	for(unsigned x=0; x<node_count; ++x)
+		cch.down_first_out[x+1] += cch.down_first_out[x];
+	cch.down_head.resize(cch_arc_count);
+	cch.down_to_up.resize(cch_arc_count);
+	{
+		std::vector<unsigned>next_down(cch.down_first_out.begin(), cch.down_first_out.end()-1);
+		for(unsigned xy=0; xy<cch_arc_count; ++xy){
+			unsigned i = next_down[cch.up_head[xy]]++;
+			cch.down_head[i] = cch.up_tail[xy];
+			cch.down_to_up[i] = xy;
+		}
+	}
+
+	// Map every input arc onto its upward arc. The first input arc in each direction
+	// is stored directly, further ones are extra input arcs.
+	auto find_up_arc = [&](unsigned x, unsigned y){
+		auto begin = cch.up_head.begin() + cch.up_first_out[x], end = cch.up_head.begin() + cch.up_first_out[x+1];
+		auto i = std::lower_bound(begin, end, y);
+		if(i == end || *i != y)
+			return RoutingKit::invalid_id;
+		return static_cast<unsigned>(i - cch.up_head.begin());
+	};
+
+	cch.input_arc_to_cch_arc.assign(input_arc_count, RoutingKit::invalid_id);
+	cch.is_input_arc_upward = RoutingKit::BitVector(input_arc_count, false);
+	cch.does_cch_arc_have_input_arc = RoutingKit::BitVector(cch_arc_count, false);
+	cch.does_cch_arc_have_extra_input_arc = RoutingKit::BitVector(cch_arc_count, false);
+	cch.forward_input_arc_of_cch.assign(cch_arc_count, RoutingKit::invalid_id);
+	cch.backward_input_arc_of_cch.assign(cch_arc_count, RoutingKit::invalid_id);
+
+	std::vector<unsigned>extra_forward_count(cch_arc_count, 0), extra_backward_count(cch_arc_count, 0);
+	for(unsigned i=0; i<input_arc_count; ++i){
+		if(tail[i] >= node_count || head[i] >= node_count)
+			throw std::runtime_error("The graph does not match \""+file_name+"\"");
+		unsigned x = cch.rank[tail[i]], y = cch.rank[head[i]];
+		if(x == y)
+			continue;
+		bool is_upward = x < y;
+		unsigned xy = is_upward ? find_up_arc(x, y) : find_up_arc(y, x);
+		if(xy == RoutingKit::invalid_id)
+			throw std::runtime_error("The graph does not match \""+file_name+"\"");
+
+		cch.input_arc_to_cch_arc[i] = xy;
+		if(is_upward)
+			cch.is_input_arc_upward.set(i);
+		cch.does_cch_arc_have_input_arc.set(xy);
+
+		auto&input_arc = is_upward ? cch.forward_input_arc_of_cch : cch.backward_input_arc_of_cch;
+		if(input_arc[xy] == RoutingKit::invalid_id){
+			input_arc[xy] = i;
+		}else{
+			cch.does_cch_arc_have_extra_input_arc.set(xy);
+			++(is_upward ? extra_forward_count : extra_backward_count)[xy];
+		}
+	}
+
+	auto build_extra_input_arcs = [&](
+		bool is_upward, const std::vector<unsigned>&extra_count,
+		std::vector<unsigned>&first_extra, std::vector<unsigned>&extra
+	){
+		const auto&input_arc = is_upward ? cch.forward_input_arc_of_cch : cch.backward_input_arc_of_cch;
+		first_extra.assign(cch_arc_count+1, 0);
+		for(unsigned xy=0; xy<cch_arc_count; ++xy)
+			first_extra[xy+1] = first_extra[xy] + extra_count[xy];
+		extra.resize(first_extra[cch_arc_count]);
+		std::vector<unsigned>next_extra(first_extra.begin(), first_extra.end()-1);
+		for(unsigned i=0; i<input_arc_count; ++i){
+			unsigned xy = cch.input_arc_to_cch_arc[i];
+			if(xy != RoutingKit::invalid_id && cch.is_input_arc_upward.is_set(i) == is_upward && input_arc[xy] != i)
+				extra[next_extra[xy]++] = i;
+		}
+	};
+	build_extra_input_arcs(true, extra_forward_count, cch.first_extra_forward_input_arc_of_cch, cch.extra_forward_input_arc_of_cch);
+	build_extra_input_arcs(false, extra_backward_count, cch.first_extra_backward_input_arc_of_cch, cch.extra_backward_input_arc_of_cch);
+
+	return cch; // NVRO
+}
+
+//! Checks that a CCH built by load_routingkit_cch_structure equals the one that
+//! RoutingKit contracts for the same order and graph. The upward arcs, the mapping
+//! of the input arcs onto them, and the metric customized with weight are compared.
+//! Which of the input arcs of an upward arc is stored directly and which ones are
+//! extra input arcs may differ. Throws if the CCHs differ.
+inline void verify_routingkit_cch_structure(
+	const RoutingKit::CustomizableContractionHierarchy&cch,
+	const std::vector<unsigned>&order,
+	const std::vector<unsigned>&tail, const std::vector<unsigned>&head,
+	const std::vector<unsigned>&weight
+){
+	RoutingKit::CustomizableContractionHierarchy expected(order, tail, head);
+
+	auto check = [](bool is_equal, const std::string&what){
+		if(!is_equal)
+			throw std::runtime_error("The CCH built from the structure file differs from the contracted one in "+what);
+	};
+
+	check(cch.rank == expected.rank && cch.order == expected.order, "the order");
+	check(cch.up_first_out == expected.up_first_out && cch.up_head == expected.up_head, "the upward arcs");
+
+	const unsigned input_arc_count = tail.size();
+	const unsigned cch_arc_count = cch.up_head.size();
+
+	check(cch.input_arc_to_cch_arc == expected.input_arc_to_cch_arc, "the input arc mapping");
+	for(unsigned i=0; i<input_arc_count; ++i)
+		check(cch.is_input_arc_upward.is_set(i) == expected.is_input_arc_upward.is_set(i), "the direction of input arc "+std::to_string(i));
+
+	auto get_input_arcs = [](
+		const RoutingKit::CustomizableContractionHierarchy&c, unsigned xy, bool is_forward
+	){
+		const auto&input_arc = is_forward ? c.forward_input_arc_of_cch : c.backward_input_arc_of_cch;
+		const auto&first_extra = is_forward ? c.first_extra_forward_input_arc_of_cch : c.first_extra_backward_input_arc_of_cch;
+		const auto&extra = is_forward ? c.extra_forward_input_arc_of_cch : c.extra_backward_input_arc_of_cch;
+		std::vector<unsigned>arcs;
+		if(input_arc[xy] != RoutingKit::invalid_id)
+			arcs.push_back(input_arc[xy]);
+		for(unsigned j=first_extra[xy]; j<first_extra[xy+1]; ++j)
+			arcs.push_back(extra[j]);
+		std::sort(arcs.begin(), arcs.end());
+		return arcs;
+	};
+	for(unsigned xy=0; xy<cch_arc_count; ++xy){
+		check(cch.does_cch_arc_have_input_arc.is_set(xy) == expected.does_cch_arc_have_input_arc.is_set(xy), "the input arcs of upward arc "+std::to_string(xy));
+		for(bool is_forward:{true, false})
+			check(get_input_arcs(cch, xy, is_forward) == get_input_arcs(expected, xy, is_forward), "the input arcs of upward arc "+std::to_string(xy));
+	}
+
+	RoutingKit::CustomizableContractionHierarchyMetric metric(cch, weight), expected_metric(expected, weight);
+	metric.customize();
+	expected_metric.customize();
+	check(metric.forward == expected_metric.forward && metric.backward == expected_metric.backward, "the customized metric");
+}
+
+#endif
@@ -9,17 +9,46 @@
 #include "min_max.h"
 #include "timer.h"
 
-#include <tbb/spin_mutex.h>
+#include "concurrent_best_cut.h"
+#include "order_trace.h"
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
 
 namespace flow_cutter{
 
 	template <typename CutterFactory, class GetGeoPos>
 	class ComputeSeparator{
 	public:
-		explicit ComputeSeparator(const GetGeoPos& geo_pos, Config config):geo_pos(geo_pos), config(config){}
+		explicit ComputeSeparator(const GetGeoPos& geo_pos, Config config):geo_pos(geo_pos), config(config), projection_orders(make_projection_orders(geo_pos, config)){}
 
 		template<class Tail, class Head, class InputNodeID, class ArcWeight>
 		std::vector<int> operator()(const Tail&tail, const Head&head, const InputNodeID& input_node_id, const ArcWeight&arc_weight)const{
+			return compute_separator(tail, head, input_node_id, arc_weight, [](auto&){}, [](const auto&){});
+		}
+
+		//! Same as above, but also measures and stores the work of every cutter and the
+		//! idle time of the threads in separator_trace.
+		template<class Tail, class Head, class InputNodeID, class ArcWeight>
+		std::vector<int> operator()(const Tail&tail, const Head&head, const InputNodeID& input_node_id, const ArcWeight&arc_weight, cch_order::SeparatorTrace&separator_trace)const{
+			return compute_separator(
+				tail, head, input_node_id, arc_weight,
+				[](auto&cutter){
+					cutter.set_timed(true);
+				},
+				[&](const auto&cutter){
+					separator_trace.cutter = cutter.get_cutter_statistics();
+					separator_trace.scheduler = cutter.get_scheduler_statistics();
+				}
+			);
+		}
+
+	private:
+		//! prepare_cutter is called with every cutter before it is initialized and
+		//! report_cutter after it enumerated its cuts.
+		template<class Tail, class Head, class InputNodeID, class ArcWeight, class PrepareCutter, class ReportCutter>
+		std::vector<int> compute_separator(const Tail&tail, const Head&head, const InputNodeID& input_node_id, const ArcWeight&arc_weight, const PrepareCutter&prepare_cutter, const ReportCutter&report_cutter)const{
 
 			const int node_count = tail.image_count();
 			const int arc_count = tail.preimage_count();
@@ -35,26 +64,16 @@ namespace flow_cutter{
 
 			switch(config.separator_selection){
 				case Config::SeparatorSelection::node_min_expansion:
-				{
-					
-					auto expanded_graph = expanded_graph::make_graph(
-						make_const_ref_id_id_func(tail), 
-						make_const_ref_id_id_func(head), 
-						make_const_ref_id_id_func(back_arc), 
-						make_const_ref_id_id_func(arc_weight), 
-						make_const_ref_id_func(out_arc)
-					);
-					auto cutter = factory(expanded_graph);
-					auto pairs = factory.select_source_target_pairs(node_count, adapted_geo_pos, config.cutter_count, config.random_seed);
-
-					std::atomic<double> best_score(std::numeric_limits<double>::max());
-					int best_flow_intensity = std::numeric_limits<int>::max();
-					int best_cutter_id = std::numeric_limits<int>::max();
+				with_expanded_graph(tail, head, back_arc, arc_weight, out_arc, [&](const auto& expanded_graph){
+					// Ordered by score, then flow intensity, then cutter id
+					ConcurrentBestCut<std::tuple<double, int, int>, CutSnapshot> best_cut(std::make_tuple(std::numeric_limits<double>::max(), std::numeric_limits<int>::max(), std::numeric_limits<int>::max()));
 
 					auto expanded_geo_pos = id_func(expanded_graph.node_count(), [&](int x) -> GeoPos {return adapted_geo_pos(expanded_graph::expanded_node_to_original_node(x));});
-					cutter.init(expanded_graph::expand_source_target_pair_list(std::move(pairs)), config.random_seed, expanded_geo_pos);
 
-					tbb::spin_mutex current_cut_mutex;
+					auto cutter = factory(expanded_graph);
+					prepare_cutter(cutter);
+					auto pairs = select_source_target_pairs(factory, node_count, adapted_geo_pos, input_node_id);
+					cutter.init(expanded_graph::expand_source_target_pair_list(std::move(pairs)), config.random_seed, expanded_geo_pos);
 
 					cutter.enum_cuts(
 							 /* shall_continue */
@@ -65,7 +84,7 @@ namespace flow_cutter{
 									 cut_size += 1;
 								 }
 								double potential_best_next_score = cut_size/(double)(expanded_graph::expanded_node_count(node_count)/2);
-								return potential_best_next_score <= best_score.load(std::memory_order_acquire);
+								return potential_best_next_score <= std::get<0>(best_cut.get_best_key());
 							 },
 							 /* report_cut */
 							 [&](const auto& cutter, int cutter_id) {
@@ -77,23 +96,15 @@ namespace flow_cutter{
 								if(cutter.get_current_smaller_cut_side_size() < config.max_imbalance * expanded_graph::expanded_node_count(node_count))
 									score += 1000000;
 
-
-								if(score <= best_score.load(std::memory_order_acquire)) {
-									tbb::spin_mutex::scoped_lock cut_lock(current_cut_mutex);
-
-									double tmp_best_score = best_score.load(std::memory_order_acquire);
-
-									if (std::tie(score, cut_size, cutter_id) < std::tie(tmp_best_score, best_flow_intensity, best_cutter_id)) {
-										best_score.store(score, std::memory_order_release);
-										best_flow_intensity = cut_size;
-										best_cutter_id = cutter_id;
-										separator = expanded_graph::extract_original_separator_from_cut(tail, head, expanded_graph, cutter).sep;
-									}
-								}
+								best_cut.try_publish(std::make_tuple(score, cutter.get_current_flow_intensity(), cutter_id), [&]{ return CutSnapshot(cutter); });
 							 },
 							 /* report_cuts_in_order */
 							 false);
-				}
+					report_cutter(cutter);
+
+					if(best_cut.was_cut_published())
+						separator = expanded_graph::extract_original_separator_from_cut(tail, head, expanded_graph, best_cut.get_best_cut()).sep;
+				});
 				break;
 				case Config::SeparatorSelection::edge_min_expansion:
 				{
@@ -107,13 +118,11 @@ namespace flow_cutter{
 					);
 
 					auto cutter = factory(graph);
+					prepare_cutter(cutter);
 
-					std::vector<int>best_cut;
-					std::atomic<double> best_score(std::numeric_limits<double>::max());
-
-					cutter.init(factory.select_source_target_pairs(node_count, adapted_geo_pos, config.cutter_count, config.random_seed), config.random_seed, adapted_geo_pos);
+					ConcurrentBestCut<double, std::vector<int>> best_cut(std::numeric_limits<double>::max());
 
-					tbb::spin_mutex current_cut_mutex;
+					cutter.init(select_source_target_pairs(factory, node_count, adapted_geo_pos, input_node_id), config.random_seed, adapted_geo_pos);
 
 					cutter.enum_cuts(
 							 /* shall_continue */
@@ -124,7 +133,7 @@ namespace flow_cutter{
 									 cut_size += 1;
 								 }
 								double potential_best_next_score = cut_size/(double)(node_count/2);
-								return potential_best_next_score < best_score.load(std::memory_order_acquire);
+								return potential_best_next_score < best_cut.get_best_key();
 							 },
 							 /* report_cut */
 							 [&](const auto& cutter, int) {
@@ -136,21 +145,13 @@ namespace flow_cutter{
 								if(cutter.get_current_smaller_cut_side_size() < config.max_imbalance * node_count)
 									score += 1000000;
 
-
-								if(score < best_score.load(std::memory_order_acquire)) {
-									tbb::spin_mutex::scoped_lock cut_lock(current_cut_mutex);
-
-									if (score < best_score.load(std::memory_order_acquire)) {
-										best_score.store(score, std::memory_order_release);
-										best_cut = cutter.get_current_cut();
-									}
-
-								}
+								best_cut.try_publish(score, [&]{ return cutter.get_current_cut(); });
 							 },
 							 /* report_cuts_in_order */
 							 false);
+					report_cutter(cutter);
 
-					for(auto x:best_cut)
+					for(auto x:best_cut.get_best_cut())
 						separator.push_back(head(x));
 
 					std::sort(separator.begin(), separator.end());
@@ -169,12 +170,11 @@ namespace flow_cutter{
 					);
 
 					auto cutter = factory(graph);
-					cutter.init(factory.select_source_target_pairs(node_count, adapted_geo_pos, config.cutter_count, config.random_seed), config.random_seed, adapted_geo_pos);
+					prepare_cutter(cutter);
+					cutter.init(select_source_target_pairs(factory, node_count, adapted_geo_pos, input_node_id), config.random_seed, adapted_geo_pos);
 
-					int best_small_side_size = 0;
-					std::vector<int> best_cut;
-					std::atomic<int> best_cut_size(std::numeric_limits<int>::max());
-					tbb::spin_mutex  current_cut_mutex;
+					// Ordered by cut size, then by the negated smaller side size
+					ConcurrentBestCut<std::tuple<int, int>, std::vector<int>> best_cut(std::make_tuple(std::numeric_limits<int>::max(), 0));
 
 					cutter.enum_cuts(
 							 /* shall_continue */
@@ -185,7 +185,7 @@ namespace flow_cutter{
 									 cut_size += 1;
 								 }
 
-								 return cut_size <= best_cut_size.load(std::memory_order_acquire);
+								 return cut_size <= std::get<0>(best_cut.get_best_key());
 							 },
 							 /* report_cut */
 							 [&](const auto& cutter, int) {
@@ -195,24 +195,13 @@ namespace flow_cutter{
 								if(cutter.get_current_smaller_cut_side_size() < config.max_imbalance * node_count)
 									return;
 
-
-								if(cut_size <= best_cut_size.load(std::memory_order_acquire)) {
-									tbb::spin_mutex::scoped_lock cut_lock(current_cut_mutex);
-
-									const int tmp_best_cut_size = best_cut_size.load(std::memory_order_acquire);
-
-									if (cut_size < tmp_best_cut_size ||
-									    (cut_size == tmp_best_cut_size && best_small_side_size < small_side_size)) {
-										best_cut_size.store(cut_size, std::memory_order_release);
-										best_small_side_size = small_side_size;
-										best_cut = cutter.get_current_cut();
-									}
-								}
+								best_cut.try_publish(std::make_tuple(cut_size, -small_side_size), [&]{ return cutter.get_current_cut(); });
 							 },
 							 /* report_cuts_in_order */
 							 false);
+					report_cutter(cutter);
 
-					for(auto x : best_cut)
+					for(auto x : best_cut.get_best_cut())
 						separator.push_back(head(x));
 
 					std::sort(separator.begin(), separator.end());
@@ -220,24 +209,16 @@ namespace flow_cutter{
 				}
 				break;
 				case Config::SeparatorSelection::node_first:
-				{
-					auto expanded_graph = expanded_graph::make_graph(
-						make_const_ref_id_id_func(tail), 
-						make_const_ref_id_id_func(head), 
-						make_const_ref_id_id_func(back_arc), 
-						make_const_ref_id_id_func(arc_weight), 
-						make_const_ref_id_func(out_arc)
-					);
-
+				with_expanded_graph(tail, head, back_arc, arc_weight, out_arc, [&](const auto& expanded_graph){
 					auto cutter = factory(expanded_graph);
-					auto pairs = factory.select_source_target_pairs(node_count, adapted_geo_pos, config.cutter_count, config.random_seed);
+					prepare_cutter(cutter);
+					auto pairs = select_source_target_pairs(factory, node_count, adapted_geo_pos, input_node_id);
 
 					auto expanded_geo_pos = id_func(expanded_graph.node_count(), [&](int x) -> GeoPos {return adapted_geo_pos(expanded_graph::expanded_node_to_original_node(x));});
 					cutter.init(expanded_graph::expand_source_target_pair_list(pairs), config.random_seed, expanded_geo_pos);
 
-					int best_small_side_size = 0;
-					std::atomic<int> best_cut_size(std::numeric_limits<int>::max());
-					tbb::spin_mutex  current_cut_mutex;
+					// Ordered by cut size, then by the negated smaller side size
+					ConcurrentBestCut<std::tuple<int, int>, CutSnapshot> best_cut(std::make_tuple(std::numeric_limits<int>::max(), 0));
 
 					cutter.enum_cuts(
 							 /* shall_continue */
@@ -248,7 +229,7 @@ namespace flow_cutter{
 									 cut_size += 1;
 								 }
 
-								 return cut_size <= best_cut_size.load(std::memory_order_acquire);
+								 return cut_size <= std::get<0>(best_cut.get_best_key());
 							 },
 							 /* report_cut */
 							 [&](const auto& cutter, int) {
@@ -258,24 +239,15 @@ namespace flow_cutter{
 								if(cutter.get_current_smaller_cut_side_size() < config.max_imbalance * expanded_graph::expanded_node_count(node_count))
 									return;
 
-
-								if(cut_size <= best_cut_size.load(std::memory_order_acquire)) {
-									tbb::spin_mutex::scoped_lock cut_lock(current_cut_mutex);
-
-									const int tmp_best_cut_size = best_cut_size.load(std::memory_order_acquire);
-
-									if (cut_size < tmp_best_cut_size ||
-									    (cut_size == tmp_best_cut_size && best_small_side_size < small_side_size)) {
-										best_cut_size.store(cut_size, std::memory_order_release);
-										best_small_side_size = small_side_size;
-										separator = expanded_graph::extract_original_separator_from_cut(tail, head, expanded_graph, cutter).sep;
-									}
-								}
+								best_cut.try_publish(std::make_tuple(cut_size, -small_side_size), [&]{ return CutSnapshot(cutter); });
 							 },
 							 /* report_cuts_in_order */
 							 false);
+					report_cutter(cutter);
 
-				}
+					if(best_cut.was_cut_published())
+						separator = expanded_graph::extract_original_separator_from_cut(tail, head, expanded_graph, best_cut.get_best_cut()).sep;
+				});
 				break;
 				default:
 					throw std::logic_error("Invalid separator selection config");
@@ -284,9 +256,44 @@ namespace flow_cutter{
 			return separator;
 
 		}
-	private:
+
+		//! Builds the expanded graph in the layout selected by config.expanded_graph_layout and passes it to f.
+		template<class Tail, class Head, class BackArc, class ArcWeight, class OutArc, class F>
+		void with_expanded_graph(const Tail&tail, const Head&head, const BackArc&back_arc, const ArcWeight&arc_weight, const OutArc&out_arc, const F&f)const{
+			if(config.expanded_graph_layout == Config::ExpandedGraphLayout::materialized){
+				f(expanded_graph::make_materialized_graph(tail, head, back_arc, arc_weight, out_arc));
+			}else{
+				f(expanded_graph::make_graph(
+					make_const_ref_id_id_func(tail), 
+					make_const_ref_id_id_func(head), 
+					make_const_ref_id_id_func(back_arc), 
+					make_const_ref_id_id_func(arc_weight), 
+					make_const_ref_id_func(out_arc)
+				));
+			}
+		}
+
+		template<class Factory, class AdaptedGeoPos, class InputNodeID>
+		auto select_source_target_pairs(Factory& factory, int node_count, AdaptedGeoPos& adapted_geo_pos, const InputNodeID& input_node_id)const{
+			if(projection_orders)
+				return factory.select_source_target_pairs(node_count, *projection_orders, input_node_id, config.cutter_count, config.random_seed);
+			else
+				return factory.select_source_target_pairs(node_count, adapted_geo_pos, config.cutter_count, config.random_seed);
+		}
+
+
+		//! Only the accelerated cutters start from the projection orders, the others ignore them.
+		static std::shared_ptr<const flow_cutter_accelerated::InertialProjectionOrders> make_projection_orders(const GetGeoPos& geo_pos, const Config& config){
+			if(std::is_same<CutterFactory, flow_cutter_accelerated::CutterFactory>::value && config.reuse_geo_orders == Config::ReuseGeoOrders::yes)
+				return std::make_shared<const flow_cutter_accelerated::InertialProjectionOrders>(geo_pos, config.geo_pos_ordering_cutter_count);
+			else
+				return nullptr;
+		}
+
 		const GetGeoPos& geo_pos;
 		Config config;
+		//! Only set if config.reuse_geo_orders is enabled and the cutters are accelerated. Shared among copies of the functor.
+		std::shared_ptr<const flow_cutter_accelerated::InertialProjectionOrders> projection_orders;
 	};
 
 
@@ -0,0 +1,325 @@
+#ifndef SEPARATOR_HIERARCHY_H
+#define SEPARATOR_HIERARCHY_H
+
+#include "array_id_func.h"
+#include "tiny_id_func.h"
+#include "union_find.h"
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <fstream>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace cch_order{
+
+	//! The separators that a nested dissection order computation found. Every
+	//! separator belongs to a sub-problem and the parent of a sub-problem is the
+	//! sub-problem whose separator split it off. The parent of the roots is no_parent.
+	//! The separators are stored as node ids of the whole graph.
+	//!
+	//! Besides the separator, each sub-problem records its node count and the node
+	//! count of its largest component after the separator was removed. These are
+	//! needed to decide whether a separator can be reused for an edited graph.
+	class SeparatorHierarchy{
+	public:
+		static constexpr int no_parent = -1;
+		static constexpr int no_sub_problem = -2;
+
+		SeparatorHierarchy():node_count(0){}
+
+		explicit SeparatorHierarchy(int node_count):node_count(node_count){}
+
+		SeparatorHierarchy(const SeparatorHierarchy&) = delete;
+		SeparatorHierarchy&operator=(const SeparatorHierarchy&) = delete;
+
+		int get_node_count()const{
+			return node_count;
+		}
+
+		int get_sub_problem_count()const{
+			return sub_problem.size();
+		}
+
+		//! May be called concurrently. parent must have been returned by an earlier call
+		//! or be no_parent. Returns the id of the new sub-problem.
+		int add_sub_problem(int parent, std::vector<int>separator, int sub_problem_node_count, int largest_component_node_count){
+			for(int x:separator){
+				(void)x;
+				assert(0 <= x && x < node_count);
+			}
+
+			std::lock_guard<std::mutex>lock(sub_problem_lock);
+			assert(parent == no_parent || (0 <= parent && parent < get_sub_problem_count()));
+			int id = sub_problem.size();
+			sub_problem.push_back({parent, sub_problem_node_count, largest_component_node_count, std::move(separator)});
+			is_index_valid = false;
+			return id;
+		}
+
+		int get_parent(int s)const{
+			return sub_problem[s].parent;
+		}
+
+		const std::vector<int>&get_separator(int s)const{
+			return sub_problem[s].separator;
+		}
+
+		int get_sub_problem_node_count(int s)const{
+			return sub_problem[s].node_count;
+		}
+
+		int get_largest_component_node_count(int s)const{
+			return sub_problem[s].largest_component_node_count;
+		}
+
+		//! Replaces every node id x by new_node_id(x). Nodes mapped to -1 are removed.
+		template<class NewNodeID>
+		void relabel_nodes(const NewNodeID&new_node_id, int new_node_count){
+			for(auto&s:sub_problem){
+				std::vector<int>separator;
+				for(int x:s.separator){
+					int y = new_node_id(x);
+					assert(-1 <= y && y < new_node_count);
+					if(y != -1)
+						separator.push_back(y);
+				}
+				s.separator = std::move(separator);
+			}
+			node_count = new_node_count;
+			is_index_valid = false;
+		}
+
+		//! Builds the index needed by find_sub_problem. Must be called after the last
+		//! sub-problem was added or the nodes were relabeled.
+		void build_index(){
+			const int sub_problem_count = get_sub_problem_count();
+
+			separator_of_node.assign(node_count, -1);
+			for(int s=0; s<sub_problem_count; ++s)
+				for(int x:sub_problem[s].separator)
+					separator_of_node[x] = s;
+
+			// Number the sub-problems in preorder, such that every subtree is a range.
+			root_children.clear();
+			std::vector<std::vector<int>>children(sub_problem_count);
+			for(int s=0; s<sub_problem_count; ++s){
+				if(sub_problem[s].parent == no_parent)
+					root_children.push_back(s);
+				else
+					children[sub_problem[s].parent].push_back(s);
+			}
+
+			subtree_begin.assign(sub_problem_count, 0);
+			subtree_end.assign(sub_problem_count, 0);
+			std::vector<std::pair<int, unsigned>>stack;
+			int next_preorder_id = 0;
+			for(int r:root_children){
+				subtree_begin[r] = next_preorder_id++;
+				stack.push_back({r, 0});
+				while(!stack.empty()){
+					int s = stack.back().first;
+					unsigned&next_child = stack.back().second;
+					if(next_child < children[s].size()){
+						int c = children[s][next_child++];
+						subtree_begin[c] = next_preorder_id++;
+						stack.push_back({c, 0});
+					}else{
+						subtree_end[s] = next_preorder_id;
+						stack.pop_back();
+					}
+				}
+			}
+
+			child = std::move(children);
+			is_index_valid = true;
+		}
+
+		//! Returns the sub-problem whose separator contains x, or no_sub_problem.
+		int get_sub_problem_of_separator_node(int x)const{
+			assert(is_index_valid);
+			if(x >= node_count)
+				return no_sub_problem;
+			int s = separator_of_node[x];
+			return s == -1 ? no_sub_problem : s;
+		}
+
+		//! Returns the child of parent (or the root that the parent no_parent stands for)
+		//! that contains most of the nodes in node_id, given as node ids of the whole
+		//! graph. A node only counts if it is in the separator of a sub-problem. Returns
+		//! no_sub_problem if no node counts or parent is no_sub_problem.
+		template<class NodeID>
+		int find_sub_problem(int parent, const NodeID&node_id)const{
+			assert(is_index_valid);
+			if(parent == no_sub_problem)
+				return no_sub_problem;
+			const std::vector<int>&candidates = parent == no_parent ? root_children : child[parent];
+			if(candidates.empty())
+				return no_sub_problem;
+
+			std::vector<int>votes(candidates.size(), 0);
+			for(int i=0; i<node_id.preimage_count(); ++i){
+				int s = get_sub_problem_of_separator_node(node_id(i));
+				if(s == no_sub_problem)
+					continue;
+				int s_begin = subtree_begin[s];
+				auto iter = std::upper_bound(
+					candidates.begin(), candidates.end(), s_begin,
+					[&](int b, int c){ return b < subtree_begin[c]; }
+				);
+				if(iter == candidates.begin())
+					continue;
+				--iter;
+				if(s_begin < subtree_end[*iter])
+					++votes[iter - candidates.begin()];
+			}
+
+			auto best = std::max_element(votes.begin(), votes.end());
+			if(*best == 0)
+				return no_sub_problem;
+			return candidates[best - votes.begin()];
+		}
+
+		void save(const std::string&file_name)const{
+			std::ofstream out(file_name, std::ios::binary);
+			if(!out)
+				throw std::runtime_error("Can not open \""+file_name+"\" for writing.");
+			out.write(get_magic(), MagicSize);
+			write_value(out, node_count);
+			write_value(out, get_sub_problem_count());
+			for(auto&s:sub_problem){
+				write_value(out, s.parent);
+				write_value(out, s.node_count);
+				write_value(out, s.largest_component_node_count);
+				write_value(out, static_cast<int>(s.separator.size()));
+				out.write(reinterpret_cast<const char*>(s.separator.data()), s.separator.size()*sizeof(int));
+			}
+			if(!out)
+				throw std::runtime_error("Can not write to \""+file_name+"\".");
+		}
+
+		void load(const std::string&file_name){
+			std::ifstream in(file_name, std::ios::binary);
+			if(!in)
+				throw std::runtime_error("Can not open \""+file_name+"\" for reading.");
+
+			auto corrupt = [&]{
+				return std::runtime_error("Separator hierarchy file \""+file_name+"\" is corrupt.");
+			};
+
+			char file_magic[MagicSize];
+			in.read(file_magic, MagicSize);
+			if(!in || std::memcmp(file_magic, get_magic(), MagicSize) != 0)
+				throw std::runtime_error("\""+file_name+"\" is no separator hierarchy file.");
+
+			int new_node_count, sub_problem_count;
+			if(!read_value(in, new_node_count) || !read_value(in, sub_problem_count) || new_node_count < 0 || sub_problem_count < 0)
+				throw corrupt();
+
+			std::vector<SubProblem>new_sub_problem(sub_problem_count);
+			for(int s=0; s<sub_problem_count; ++s){
+				auto&p = new_sub_problem[s];
+				int separator_size;
+				if(!read_value(in, p.parent) || !read_value(in, p.node_count) || !read_value(in, p.largest_component_node_count) || !read_value(in, separator_size))
+					throw corrupt();
+				if(p.parent < no_parent || p.parent >= s || separator_size < 0 || separator_size > new_node_count)
+					throw corrupt();
+				p.separator.resize(separator_size);
+				in.read(reinterpret_cast<char*>(p.separator.data()), separator_size*sizeof(int));
+				if(!in)
+					throw corrupt();
+				for(int x:p.separator)
+					if(x < 0 || x >= new_node_count)
+						throw corrupt();
+			}
+
+			node_count = new_node_count;
+			sub_problem = std::move(new_sub_problem);
+			is_index_valid = false;
+		}
+
+	private:
+		static const char*get_magic(){
+			return "IFCSEPH1";
+		}
+		static constexpr int MagicSize = 8;
+
+		template<class T>
+		static void write_value(std::ostream&out, const T&x){
+			out.write(reinterpret_cast<const char*>(&x), sizeof(x));
+		}
+
+		template<class T>
+		static bool read_value(std::istream&in, T&x){
+			in.read(reinterpret_cast<char*>(&x), sizeof(x));
+			return static_cast<bool>(in);
+		}
+
+		struct SubProblem{
+			int parent;
+			int node_count;
+			int largest_component_node_count;
+			std::vector<int>separator;
+		};
+
+		int node_count;
+		std::mutex sub_problem_lock;
+		std::vector<SubProblem>sub_problem;
+
+		bool is_index_valid = false;
+		std::vector<int>separator_of_node;
+		std::vector<int>root_children;
+		std::vector<std::vector<int>>child;
+		std::vector<int>subtree_begin, subtree_end;
+	};
+
+	//! Computes the node count of the largest component that remains when the
+	//! separator nodes are removed from the graph.
+	template<class Tail, class Head>
+	int compute_largest_component_node_count_without_separator(const Tail&tail, const Head&head, const std::vector<int>&separator){
+		const int node_count = tail.image_count();
+		const int arc_count = tail.preimage_count();
+
+		BitIDFunc in_separator(node_count);
+		in_separator.fill(false);
+		for(int x:separator)
+			in_separator.set(x, true);
+
+		UnionFind uf(node_count);
+		for(int xy=0; xy<arc_count; ++xy){
+			int x = tail(xy), y = head(xy);
+			if(!in_separator(x) && !in_separator(y))
+				uf.unite(x, y);
+		}
+
+		std::vector<int>component_size(node_count, 0);
+		int largest = 0;
+		for(int x=0; x<node_count; ++x)
+			if(!in_separator(x))
+				largest = std::max(largest, ++component_size[uf(x)]);
+		return largest;
+	}
+
+	//! The state of an order computation that reuses the separators of an old
+	//! hierarchy and records the separators it uses in a new hierarchy. A reused
+	//! separator must be as balanced as a freshly computed cut: No component may
+	//! have more than (1-max_imbalance) times the nodes of the graph, unless the
+	//! old separator already had such a component. The cutters only prefer balanced
+	//! cuts, too.
+	struct SeparatorHierarchyUpdate{
+		SeparatorHierarchyUpdate(const SeparatorHierarchy&old_hierarchy, SeparatorHierarchy&new_hierarchy, double max_imbalance):
+			old_hierarchy(old_hierarchy), new_hierarchy(new_hierarchy), max_imbalance(max_imbalance),
+			reused_separator_count(0), computed_separator_count(0){}
+
+		const SeparatorHierarchy&old_hierarchy;
+		SeparatorHierarchy&new_hierarchy;
+		double max_imbalance;
+		std::atomic<int>reused_separator_count;
+		std::atomic<int>computed_separator_count;
+	};
+}
+
+#endif
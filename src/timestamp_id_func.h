@@ -3,6 +3,8 @@
 
 #include "array_id_func.h"
 
+#include <cassert>
+
 //! A bool id func with a constant time fill(false). Note that fill(true) is expensive
 class TimestampIDFunc{
 public:
@@ -13,6 +15,10 @@ public:
 		current_timestamp = 1;
 	}
 
+	int preimage_count()const{
+		return timestamp.preimage_count();
+	}
+
 	bool operator()(int x)const{
 		return timestamp(x) == current_timestamp;
 	}
@@ -39,5 +45,48 @@ private:
 	unsigned short current_timestamp;
 };
 
+//! A bool id func that is the union of a base id func and a TimestampIDFunc. The base
+//! is not owned and only referenced. Replacing the base and clearing the overlay is
+//! constant time. Only elements that are not inside the base can be set to false.
+template<class BaseIDFunc>
+class TimestampOverlayIDFunc{
+public:
+	TimestampOverlayIDFunc():base(nullptr){}
+	explicit TimestampOverlayIDFunc(int node_count):
+		base(nullptr), overlay(node_count){}
+
+	int preimage_count()const{
+		return overlay.preimage_count();
+	}
+
+	bool operator()(int x)const{
+		return overlay(x) || (base != nullptr && (*base)(x));
+	}
+
+	void fill(bool f){
+		assert(!f && "Only fill(false) is supported");
+		(void)f;
+		base = nullptr;
+		overlay.fill(false);
+	}
+
+	void set(int x, bool f){
+		assert((f || base == nullptr || !(*base)(x)) && "Can not remove an element of the base");
+		overlay.set(x, f);
+	}
+
+	//! Afterwards, exactly the elements inside new_base are true. new_base must outlive
+	//! this object or the next call to fill or reset_base.
+	void reset_base(const BaseIDFunc&new_base){
+		assert(new_base.preimage_count() == preimage_count());
+		base = &new_base;
+		overlay.fill(false);
+	}
+
+private:
+	const BaseIDFunc*base;
+	TimestampIDFunc overlay;
+};
+
 #endif
 
@@ -5,6 +5,13 @@
 #include <vector>
 #include <stdexcept>
 #include <fstream>
+#include <utility>
+#include <cstddef>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 template<class T>
 void save_vector(const std::string&file_name, const std::vector<T>&vec){
@@ -61,6 +68,83 @@ std::vector<std::string>load_vector<std::string>(const std::string&file_name){
 	return ret; // NVRO
 }
 
+//! A read-only view of a binary vector file that is mapped into memory instead of
+//! being read. The pages are only loaded when they are accessed, hence the data can
+//! be fed directly into the graph construction without an intermediate copy.
+template<class T>
+class MappedVector{
+public:
+	MappedVector():data_(nullptr), size_(0){}
+
+	explicit MappedVector(const std::string&file_name):data_(nullptr), size_(0){
+		int fd = open(file_name.c_str(), O_RDONLY);
+		if(fd == -1)
+			throw std::runtime_error("Can not open \""+file_name+"\" for reading.");
+
+		struct stat file_stat;
+		if(fstat(fd, &file_stat) == -1){
+			close(fd);
+			throw std::runtime_error("Can not determine the size of \""+file_name+"\".");
+		}
+		unsigned long long file_size = file_stat.st_size;
+		if(file_size % sizeof(T) != 0){
+			close(fd);
+			throw std::runtime_error("File \""+file_name+"\" can not be a vector of the requested type because it's size is no multiple of the element type's size.");
+		}
+
+		if(file_size != 0){
+			void*mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(mapping == MAP_FAILED){
+				close(fd);
+				throw std::runtime_error("Can not map \""+file_name+"\" into memory.");
+			}
+			// The vectors are usually read from front to back. The hint only affects
+			// the read ahead, hence a failure can be ignored.
+			madvise(mapping, file_size, MADV_SEQUENTIAL);
+			data_ = static_cast<const T*>(mapping);
+			size_ = file_size / sizeof(T);
+		}
+		close(fd);
+	}
+
+	MappedVector(const MappedVector&) = delete;
+	MappedVector&operator=(const MappedVector&) = delete;
+
+	MappedVector(MappedVector&&o)noexcept:data_(o.data_), size_(o.size_){
+		o.data_ = nullptr;
+		o.size_ = 0;
+	}
+
+	MappedVector&operator=(MappedVector&&o)noexcept{
+		std::swap(data_, o.data_);
+		std::swap(size_, o.size_);
+		return *this;
+	}
+
+	~MappedVector(){
+		if(data_ != nullptr)
+			munmap(const_cast<T*>(data_), size_*sizeof(T));
+	}
+
+	std::size_t size()const{ return size_; }
+	bool empty()const{ return size_ == 0; }
+
+	const T&operator[](std::size_t i)const{ return data_[i]; }
+	const T&back()const{ return data_[size_-1]; }
+
+	const T*begin()const{ return data_; }
+	const T*end()const{ return data_ + size_; }
+
+private:
+	const T*data_;
+	std::size_t size_;
+};
+
+template<class T>
+MappedVector<T>map_vector(const std::string&file_name){
+	return MappedVector<T>(file_name);
+}
+
 template<class T>
 void save_value(const std::string&file_name, const T&val){
 	save_vector(file_name, std::vector<T>{val});